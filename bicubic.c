@@ -13,13 +13,23 @@
  * The given function values and the derivatives matches those of the interpolated surface
  * at four corners to determine 16 coefficients.
  *
+ * The batched kernels optionally limit the interpolated value to the range of
+ * the four corner values (quasi-monotone, Bermejo and Staniforth 1992), which
+ * are sums of the coefficients held in registers: \f$p(0,0)=a_{00}\f$,
+ * \f$p(1,0)=\sum_i a_{i0}\f$, \f$p(0,1)=\sum_j a_{0j}\f$ and \f$p(1,1)=\sum_{ij}a_{ij}\f$.
+ * The derivatives are not limited.
+ *
  * # Reference
  *
  * - [Numerical Recepies in C](http://www.nrbook.com/a/bookcpdf.php): 
  *   [3.6 Interpolation in Two or More Dimensions](http://www.nrbook.com/a/bookcpdf/c3-6.pdf)
  * - [Bicubic Interpolation](http://en.wikipedia.org/wiki/Bicubic)
+ * - Bermejo, R. and A. Staniforth, 1992: The conversion of semi-Lagrangian
+ *   advection schemes to quasi-monotone schemes. MWR, 120, 2622--2632.
  *  
  */
+#include <stddef.h>
+#include <stdbool.h>
 #include "bicubic.h"
 
 /// calculate coeffients from the given function values and the derivatives
@@ -40,31 +50,51 @@ void eno_bicubic_coeff
                    */
   )
 {
-  double a[16*16] = {
- 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
- 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
--3, 0, 0, 3, 0, 0, 0, 0,-2, 0, 0,-1, 0, 0, 0, 0,
- 2, 0, 0,-2, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0,
- 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
- 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
- 0, 0, 0, 0,-3, 0, 0, 3, 0, 0, 0, 0,-2, 0, 0,-1,
- 0, 0, 0, 0, 2, 0, 0,-2, 0, 0, 0, 0, 1, 0, 0, 1,
--3, 3, 0, 0,-2,-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
- 0, 0, 0, 0, 0, 0, 0, 0,-3, 3, 0, 0,-2,-1, 0, 0,
- 9,-9, 9,-9, 6, 3,-3,-6, 6,-6,-3, 3, 4, 2, 1, 2,
--6, 6,-6, 6,-4,-2, 2, 4,-3, 3, 3,-3,-2,-1,-1,-2,
- 2,-2, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
- 0, 0, 0, 0, 0, 0, 0, 0, 2,-2, 0, 0, 1, 1, 0, 0,
--6, 6,-6, 6,-3,-3, 3, 3,-4, 4, 2,-2,-2,-2,-1,-1,
- 4,-4, 4,-4, 2, 2,-2,-2, 2,-2,-2, 2, 1, 1, 1, 1
-};
-
-    for (int i = 0; i < 16; i++) {
-      c[i] = 0.0;
-      for (int j = 0; j < 16; j++) {
-        c[i] = c[i] + a[16*i+j] * f[j];
-      }
+  eno_bicubic_coeff_batch(1, f, c);
+}
+
+void eno_bicubic_coeff_batch /// calculate coefficients of n cells at once
+  (
+    int n,     /**< [in]  # of cells */
+    double *f, /**< [in]  f[16*n] as in eno_bicubic_coeff() with cells fastest:
+                *         element l of cell k in f[l*n+k]
+                */
+    double *c  /**< [out] c[16*n] bicubic coefficients with cells fastest */
+  )
+{
+/*
+ * The 16x16 matrix is the tensor product of the 4x4 cubic Hermite matrix
+ * of eno_cubic_hermite_coeff() in u and t.  The Hermite matrix is applied
+ * to the four data of each edge in u, then to the results in t.
+ */
+  static const int iu[4][4] = { // (value, derivative) at u = 0, 1 for
+    { 0,  3,  8, 11},           // f   at t = 0
+    { 1,  2,  9, 10},           // f   at t = 1
+    { 4,  7, 12, 15},           // f_x at t = 0
+    { 5,  6, 13, 14}            // f_x at t = 1
+  };
+
+#pragma omp simd
+  for (int k = 0; k < n; k++) {
+    double b[4][4];
+
+    for (int m = 0; m < 4; m++) {
+      double p0 = f[iu[m][0]*n+k];
+      double p1 = f[iu[m][1]*n+k];
+      double d0 = f[iu[m][2]*n+k];
+      double d1 = f[iu[m][3]*n+k];
+      b[m][0] = p0;
+      b[m][1] = d0;
+      b[m][2] = 3.0*(p1-p0)-2.0*d0-d1;
+      b[m][3] = 2.0*(p0-p1)+    d0+d1;
+    }
+    for (int j = 0; j < 4; j++) {
+      c[(     j)*n+k] = b[0][j];
+      c[( 4 + j)*n+k] = b[2][j];
+      c[( 8 + j)*n+k] = 3.0*(b[1][j]-b[0][j])-2.0*b[2][j]-b[3][j];
+      c[(12 + j)*n+k] = 2.0*(b[0][j]-b[1][j])+    b[2][j]+b[3][j];
     }
+  }
 }
 
 double eno_bicubic_interpolate /// interpolate at (t,u) using c[]
@@ -126,3 +156,113 @@ double eno_bicubic_interpolate_xy /// interpolate xy-derivative at (t,u) using c
   }
   return fi;
 }
+
+void eno_bicubic_interpolate_fused /// interpolate value and derivatives at (t,u) in one pass
+  (
+    double c[16], ///< [in]  coefficents obtained by eno_bicubic_coeff()
+    double t,     ///< [in]  desired point in \f$x\f$
+    double u,     ///< [in]  desired point in \f$y\f$
+    double *f,    ///< [out] \f$f\f$, skipped if NULL
+    double *fx,   ///< [out] \f$f_x\f$, skipped if NULL
+    double *fy,   ///< [out] \f$f_y\f$, skipped if NULL
+    double *fxy   ///< [out] \f$f_{xy}\f$, skipped if NULL
+  )
+{
+  eno_bicubic_interpolate_batch(1, c, &t, &u, false, f, fx, fy, fxy);
+}
+
+void eno_bicubic_interpolate_batch /// interpolate value and derivatives at n points
+  (
+    int n,       ///< [in]  # of points
+    double *c,   ///< [in]  c[16*n] coefficients of the cell of each point, points fastest
+    double *t,   ///< [in]  t[n] desired points in \f$x\f$
+    double *u,   ///< [in]  u[n] desired points in \f$y\f$
+    bool mono,   ///< [in]  limit f to the range of the corners of the cell
+    double *f,   ///< [out] f[n] \f$f\f$, skipped if NULL
+    double *fx,  ///< [out] fx[n] \f$f_x\f$, skipped if NULL
+    double *fy,  ///< [out] fy[n] \f$f_y\f$, skipped if NULL
+    double *fxy  ///< [out] fxy[n] \f$f_{xy}\f$, skipped if NULL
+  )
+{
+#pragma omp simd
+  for (int k = 0; k < n; k++) {
+    double tk = t[k];
+    double uk = u[k];
+    double p = 0.0, px = 0.0, py = 0.0, pxy = 0.0;
+    double p10 = 0.0, p11 = 0.0, p01 = 0.0;
+
+// Horner in t of the polynomials in u and their u-derivatives;
+// the t-derivatives are accumulated before p and py are updated
+    for (int i=3; i>=0; i--) {
+      double a  = ((c[(4*i+3)*n+k]*uk+c[(4*i+2)*n+k])*uk+c[(4*i+1)*n+k])*uk+c[4*i*n+k];
+      double ay = (3.0*c[(4*i+3)*n+k]*uk+2.0*c[(4*i+2)*n+k])*uk+c[(4*i+1)*n+k];
+      px  = tk*px+p;
+      pxy = tk*pxy+py;
+      p   = tk*p+a;
+      py  = tk*py+ay;
+      p01 = c[4*i*n+k]+c[(4*i+1)*n+k]+c[(4*i+2)*n+k]+c[(4*i+3)*n+k];
+      p10 += c[4*i*n+k];
+      p11 += p01;
+    }
+    if (mono) {
+      double lo = MIN(MIN(c[k], p10), MIN(p01, p11));
+      double hi = MAX(MAX(c[k], p10), MAX(p01, p11));
+      p = MAX(lo, MIN(hi, p));
+    }
+    if (f != NULL) {
+      f[k] = p;
+    }
+    if (fx != NULL) {
+      fx[k] = px;
+    }
+    if (fy != NULL) {
+      fy[k] = py;
+    }
+    if (fxy != NULL) {
+      fxy[k] = pxy;
+    }
+  }
+}
+
+void eno_bicubic_interpolate_multi /// interpolate nv variables of one cell at (t,u)
+  (
+    int nv,    ///< [in]  # of variables
+    double *c, /**< [in]  c[16*nv] coefficients by eno_bicubic_coeff_batch() with
+                *         variables fastest: coefficient l of variable v in c[l*nv+v]
+                */
+    double t,  ///< [in]  desired point in \f$x\f$
+    double u,  ///< [in]  desired point in \f$y\f$
+    bool mono, ///< [in]  limit to the range of the corners of the cell
+    double *f  ///< [out] f[nv] interpolated values
+  )
+{
+  double b[16];
+
+  for (int i=0; i<4; i++) {
+    double ti = (i == 0) ? 1.0 : b[4*(i-1)] * t;
+    b[4*i]   = ti;
+    b[4*i+1] = ti*u;
+    b[4*i+2] = ti*u*u;
+    b[4*i+3] = ti*u*u*u;
+  }
+#pragma omp simd
+  for (int v = 0; v < nv; v++) {
+    double fi = 0.0;
+    double p10 = 0.0, p11 = 0.0, p01 = 0.0;
+    for (int l = 0; l < 16; l++) {
+      fi += b[l]*c[l*nv+v];
+    }
+    for (int i = 0; i < 4; i++) {
+      double a = c[4*i*nv+v]+c[(4*i+1)*nv+v]+c[(4*i+2)*nv+v]+c[(4*i+3)*nv+v];
+      p01 = (i == 0) ? a : p01;
+      p10 += c[4*i*nv+v];
+      p11 += a;
+    }
+    if (mono) {
+      double lo = MIN(MIN(c[v], p10), MIN(p01, p11));
+      double hi = MAX(MAX(c[v], p10), MAX(p01, p11));
+      fi = MAX(lo, MIN(hi, fi));
+    }
+    f[v] = fi;
+  }
+}
@@ -0,0 +1,511 @@
+///  Bicubic regridding of a field on a rectilinear grid
+/**
+ * @file bicubic_grid.c
+ * @author Takeshi Enomoto
+ *
+ * # Algorithm
+ *
+ * The derivatives \f$f_x\f$, \f$f_y\f$ and \f$f_{xy}\f$ are estimated once per field
+ * by centred differences (one-sided at the edges)
+ * \f[
+ * f_x(i,j) = \frac{f(i+1,j)-f(i-1,j)}{x_{i+1}-x_{i-1}}
+ * \f]
+ * and the 16 coefficients of eno_bicubic_coeff_batch() are stored per cell.
+ * Cells are grouped into tiles of TILE x TILE cells, which are built either
+ * eagerly when the field is set or lazily when a target point first falls in them.
+ * Target points are sorted by tile so that each tile of coefficients is
+ * used while it is in cache.
+ *
+ * The field is stored with \f$x\f$ fastest: \f$f(i,j)\f$ = f[j*nx+i].
+ * Coordinates may be ascending or descending.
+ * Targets outside the grid are extrapolated from the nearest edge cell.
+ * eno_bicubic_grid_interpolate_multi() optionally limits the values to the range
+ * of the corners of the cell by eno_bicubic_interpolate_multi().
+ *
+ * # Sphere
+ *
+ * A grid created with eno_bicubic_grid_init_sphere() has longitude \f$x\f$ periodic
+ * with an even nx and latitude \f$y\f$ excluding the poles.
+ * Nodes beyond the first and last latitudes are read across the pole,
+ * \f$f(i,-1-j) = sf(i+n_x/2,j)\f$, with \f$s=-1\f$ for the components of a vector
+ * set by eno_bicubic_grid_set_vector(), so no padded copy of the field is made.
+ * The node mapping is done by eno_bicubic_grid_sphere_x(), eno_bicubic_grid_sphere_y()
+ * and eno_bicubic_grid_sphere_node(), which eno_semilag_departure() shares.
+ * The cells between the last latitudes and the poles are interpolated through the pole.
+ *
+ * # Reference
+ *
+ * - [Numerical Recepies in C](http://www.nrbook.com/a/bookcpdf.php):
+ *   [3.6 Interpolation in Two or More Dimensions](http://www.nrbook.com/a/bookcpdf/c3-6.pdf)
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "bicubic_grid.h"
+
+double eno_bicubic_grid_sphere_x /// x of node i of a periodic longitude, shifted by multiples of the period
+  (
+    int nx,        ///< [in] # of longitudes
+    double *x,     ///< [in] x[nx] ascending, x[0]+period excluded
+    double period, ///< [in] 360 for degrees or \f$2\pi\f$ for radians
+    int i          ///< [in] any index
+  )
+{
+  int m = (i >= 0) ? i / nx : -((nx - 1 - i) / nx);
+  return x[i - m*nx] + m * period;
+}
+
+double eno_bicubic_grid_sphere_y /// y of node j of latitudes, reflected across the poles beyond the grid
+  (
+    int ny,         ///< [in] # of latitudes
+    double *y,      ///< [in] y[ny] ascending or descending, poles excluded
+    double pole[2], ///< [in] latitudes of the poles beyond y[0] and y[ny-1]
+    int j           ///< [in] index, -ny <= j < 2*ny
+  )
+{
+  if (j < 0) {
+    return 2.0 * pole[0] - y[-1-j];
+  } else if (j >= ny) {
+    return 2.0 * pole[1] - y[2*ny-1-j];
+  }
+  return y[j];
+}
+
+double eno_bicubic_grid_sphere_node /// map node (i,j) onto the grid, return -1 if read across a pole and 1 otherwise
+  (
+    int nx, ///< [in]    # of longitudes, even
+    int ny, ///< [in]    # of latitudes
+    int *i, ///< [inout] index in x, 0 <= *i < nx on return
+    int *j  ///< [inout] index in y, -ny <= *j < 2*ny, 0 <= *j < ny on return
+  )
+{
+  double s = 1.0;
+
+  if (*j < 0 || *j >= ny) {
+    *j = (*j < 0) ? -1-*j : 2*ny-1-*j;
+    *i += nx/2;
+    s = -1.0;
+  }
+  *i = ((*i % nx) + nx) % nx;
+  return s;
+}
+
+/// x of node i, periodic on the sphere and clamped otherwise
+static double xnode(eno_bicubic_grid_t *grid, int i)
+{
+  int nx = grid->nx;
+
+  if (!grid->sphere) {
+    return grid->x[MAX(0, MIN(nx-1, i))];
+  }
+  return eno_bicubic_grid_sphere_x(nx, grid->x, grid->period, i);
+}
+
+/// y of node j, reflected across the poles on the sphere and clamped otherwise
+static double ynode(eno_bicubic_grid_t *grid, int j)
+{
+  int ny = grid->ny;
+
+  if (!grid->sphere) {
+    return grid->y[MAX(0, MIN(ny-1, j))];
+  }
+  return eno_bicubic_grid_sphere_y(ny, grid->y, grid->pole, j);
+}
+
+/// value of g at node (i,j), multiplied by s if read across a pole
+static double node
+  (
+    eno_bicubic_grid_t *grid, ///< [in] regridder
+    double *g,                ///< [in] field
+    int stride,               ///< [in] distance between nodes in g
+    double s,                 ///< [in] sign across the poles
+    int i,                    ///< [in] index in x
+    int j                     ///< [in] index in y
+  )
+{
+  int nx = grid->nx;
+  int ny = grid->ny;
+
+  if (!grid->sphere) {
+    return g[(MAX(0, MIN(ny-1, j))*nx + MAX(0, MIN(nx-1, i)))*stride];
+  }
+  if (eno_bicubic_grid_sphere_node(nx, ny, &i, &j) > 0.0) {
+    s = 1.0;
+  }
+  return s * g[(j*nx + i)*stride];
+}
+
+/// neighbours of i used by the centred difference
+static void neighbour(eno_bicubic_grid_t *grid, int i, int n, int *im, int *ip)
+{
+  if (grid->sphere) {
+    *im = i - 1;
+    *ip = i + 1;
+  } else {
+    *im = MAX(i-1, 0);
+    *ip = MIN(i+1, n-1);
+  }
+}
+
+/// centred difference in x at node (i,j), one-sided at the edges
+static double diff_x(eno_bicubic_grid_t *grid, double *g, int stride, double s, int i, int j)
+{
+  int im, ip;
+
+  neighbour(grid, i, grid->nx, &im, &ip);
+  return (node(grid, g, stride, s, ip, j) - node(grid, g, stride, s, im, j))
+       / (xnode(grid, ip) - xnode(grid, im));
+}
+
+/// centred difference in y at node (i,j), one-sided at the edges
+static double diff_y(eno_bicubic_grid_t *grid, double *g, int stride, double s, int i, int j)
+{
+  int jm, jp;
+
+  neighbour(grid, j, grid->ny, &jm, &jp);
+  return (node(grid, g, stride, s, i, jp) - node(grid, g, stride, s, i, jm))
+       / (ynode(grid, jp) - ynode(grid, jm));
+}
+
+/// centred difference in x and y at node (i,j), one-sided at the edges
+static double diff_xy(eno_bicubic_grid_t *grid, double *g, int stride, double s, int i, int j)
+{
+  int jm, jp;
+
+  neighbour(grid, j, grid->ny, &jm, &jp);
+  return (diff_x(grid, g, stride, s, i, jp) - diff_x(grid, g, stride, s, i, jm))
+       / (ynode(grid, jp) - ynode(grid, jm));
+}
+
+/// build coefficients of all cells in tile it, one row of cells at a time
+static void build_tile(eno_bicubic_grid_t *grid, int it)
+{
+  int ncx = grid->ncx;
+  int ncy = grid->ncy;
+  int i0 = (it % grid->ntx) * TILE;
+  int j0 = (it / grid->ntx) * TILE;
+  int ie = MIN(i0 + TILE, ncx);
+  int je = MIN(j0 + TILE, ncy);
+  int m = ie - i0;
+  double s = grid->sign;
+  double *c;
+  double f[16*TILE];
+  double cr[16*TILE];
+
+  if (grid->tile[it] == NULL) {
+    grid->tile[it] = (double *)malloc(sizeof(double) * 16 * TILE * TILE);
+  }
+  c = grid->tile[it];
+  for (int jc = j0; jc < je; jc++) {
+    int j = jc - grid->joff;
+    double dy = ynode(grid, j+1) - ynode(grid, j);
+    for (int i = i0; i < ie; i++) {
+      double dx = xnode(grid, i+1) - xnode(grid, i);
+      int ic[4] = {i, i+1, i+1, i};
+      int jn[4] = {j, j, j+1, j+1};
+      for (int l = 0; l < 4; l++) {
+        f[ l    *m+i-i0] = node(grid, grid->f,   1,  s, ic[l], jn[l]);
+        f[(l+4) *m+i-i0] = node(grid, grid->fx,  1,  s, ic[l], jn[l]) * dx;
+        f[(l+8) *m+i-i0] = node(grid, grid->fy,  1, -s, ic[l], jn[l]) * dy;
+        f[(l+12)*m+i-i0] = node(grid, grid->fxy, 1, -s, ic[l], jn[l]) * dx * dy;
+      }
+    }
+    eno_bicubic_coeff_batch(m, f, cr);
+    for (int i = 0; i < m; i++) {
+      for (int l = 0; l < 16; l++) {
+        c[16*((jc-j0)*TILE+i)+l] = cr[l*m+i];
+      }
+    }
+  }
+  grid->ready[it] = true;
+}
+
+/// locate the cell containing (xo, yo) and the position (t, u) in it
+static void locate
+  (
+    eno_bicubic_grid_t *grid, ///< [in]  regridder
+    double xo,                ///< [in]  target x
+    double yo,                ///< [in]  target y
+    int *i,                   ///< [out] cell index in x
+    int *j,                   ///< [out] cell index in y, -1 for the cap beyond y[0] on the sphere
+    double *t,                ///< [out] position in the cell in x
+    double *u                 ///< [out] position in the cell in y
+  )
+{
+  int nx = grid->nx;
+  int ny = grid->ny;
+
+  if (grid->sphere) {
+    xo = grid->x[0] + FMOD(xo - grid->x[0], grid->period);
+    *i = MAX(0, eno_search_bisection(grid->x, nx, xo));
+    *j = eno_search_bisection(grid->y, ny, yo);
+  } else {
+    *i = MAX(0, MIN(nx-2, eno_search_bisection(grid->x, nx, xo)));
+    *j = MAX(0, MIN(ny-2, eno_search_bisection(grid->y, ny, yo)));
+  }
+  *t = (xo - xnode(grid, *i)) / (xnode(grid, *i+1) - xnode(grid, *i));
+  *u = (yo - ynode(grid, *j)) / (ynode(grid, *j+1) - ynode(grid, *j));
+}
+
+static eno_bicubic_grid_t *alloc_grid(int nx, int ny, double *x, double *y, bool lazy, bool sphere)
+{
+  eno_bicubic_grid_t *grid;
+  grid = (eno_bicubic_grid_t *)malloc(sizeof(eno_bicubic_grid_t));
+
+  grid->nx = nx;
+  grid->ny = ny;
+  grid->x = (double *)malloc(sizeof(double) * nx);
+  grid->y = (double *)malloc(sizeof(double) * ny);
+  for (int i = 0; i < nx; i++) {
+    grid->x[i] = x[i];
+  }
+  for (int j = 0; j < ny; j++) {
+    grid->y[j] = y[j];
+  }
+  grid->sphere = sphere;
+  grid->period = 0.0;
+  grid->pole[0] = 0.0;
+  grid->pole[1] = 0.0;
+  grid->lazy = lazy;
+  grid->sign = 1.0;
+  grid->f = NULL;
+  grid->fx = (double *)malloc(sizeof(double) * nx * ny);
+  grid->fy = (double *)malloc(sizeof(double) * nx * ny);
+  grid->fxy = (double *)malloc(sizeof(double) * nx * ny);
+  if (sphere) {
+    grid->ncx = nx;
+    grid->ncy = ny + 1;
+    grid->joff = 1;
+  } else {
+    grid->ncx = nx - 1;
+    grid->ncy = ny - 1;
+    grid->joff = 0;
+  }
+  grid->ntx = (grid->ncx - 1) / TILE + 1;
+  grid->nty = (grid->ncy - 1) / TILE + 1;
+  int nt = grid->ntx * grid->nty;
+  grid->tile = (double **)malloc(sizeof(double *) * nt);
+  grid->ready = (bool *)malloc(sizeof(bool) * nt);
+  for (int it = 0; it < nt; it++) {
+    grid->tile[it] = NULL;
+    grid->ready[it] = false;
+  }
+  return grid;
+}
+
+eno_bicubic_grid_t *eno_bicubic_grid_init /// allocate regridder for an nx x ny grid
+  (
+    int nx,    ///< [in] # of points in x
+    int ny,    ///< [in] # of points in y
+    double *x, ///< [in] x[nx] ascending or descending
+    double *y, ///< [in] y[ny] ascending or descending
+    bool lazy  ///< [in] build coefficient tiles on first use instead of in eno_bicubic_grid_set()
+  )
+{
+  return alloc_grid(nx, ny, x, y, lazy, false);
+}
+
+eno_bicubic_grid_t *eno_bicubic_grid_init_sphere /// allocate regridder for a global longitude-latitude grid
+  (
+    int nlon,      ///< [in] # of longitudes, even
+    int nlat,      ///< [in] # of latitudes
+    double *lon,   ///< [in] lon[nlon] ascending, lon[0]+period excluded
+    double *lat,   ///< [in] lat[nlat] ascending or descending, poles excluded
+    double period, ///< [in] 360 for degrees or \f$2\pi\f$ for radians
+    bool lazy      ///< [in] build coefficient tiles on first use instead of in eno_bicubic_grid_set()
+  )
+{
+  eno_bicubic_grid_t *grid = alloc_grid(nlon, nlat, lon, lat, lazy, true);
+  double hp = 0.25 * period;
+
+  grid->period = period;
+  grid->pole[0] = (lat[0] > lat[nlat-1]) ? hp : -hp;
+  grid->pole[1] = -grid->pole[0];
+  return grid;
+}
+
+int eno_bicubic_grid_clean /// deallocate regridder
+  (
+    eno_bicubic_grid_t *grid ///< [inout] regridder
+  )
+{
+  for (int it = 0; it < grid->ntx * grid->nty; it++) {
+    free(grid->tile[it]);
+  }
+  free(grid->tile);
+  free(grid->ready);
+  free(grid->x);
+  free(grid->y);
+  free(grid->fx);
+  free(grid->fy);
+  free(grid->fxy);
+  free(grid);
+  return 0;
+}
+
+static int set_field(eno_bicubic_grid_t *grid, double *f, double s)
+{
+  int nx = grid->nx;
+  int ny = grid->ny;
+  int nt = grid->ntx * grid->nty;
+
+  grid->f = f;
+  grid->sign = s;
+#pragma omp parallel for
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      grid->fx[j*nx+i] = diff_x(grid, f, 1, s, i, j);
+      grid->fy[j*nx+i] = diff_y(grid, f, 1, s, i, j);
+    }
+  }
+#pragma omp parallel for
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      grid->fxy[j*nx+i] = diff_y(grid, grid->fx, 1, s, i, j);
+    }
+  }
+  for (int it = 0; it < nt; it++) {
+    grid->ready[it] = false;
+  }
+  if (!grid->lazy) {
+#pragma omp parallel for schedule(dynamic)
+    for (int it = 0; it < nt; it++) {
+      build_tile(grid, it);
+    }
+  }
+  return 0;
+}
+
+int eno_bicubic_grid_set /// set a new field and estimate its derivatives
+  (
+    eno_bicubic_grid_t *grid, ///< [inout] regridder
+    double *f                 ///< [in] f[ny*nx], referenced until the next call
+  )
+{
+  return set_field(grid, f, 1.0);
+}
+
+int eno_bicubic_grid_set_vector /// set a vector component whose sign flips across the poles
+  (
+    eno_bicubic_grid_t *grid, ///< [inout] regridder
+    double *f                 ///< [in] f[ny*nx], referenced until the next call
+  )
+{
+  return set_field(grid, f, -1.0);
+}
+
+int eno_bicubic_grid_interpolate /// interpolate the current field at target points
+  (
+    eno_bicubic_grid_t *grid, ///< [inout] regridder
+    int n,                    ///< [in] # of target points
+    double *xo,               ///< [in] xo[n] target x
+    double *yo,               ///< [in] yo[n] target y
+    double *fo                ///< [out] fo[n] interpolated values
+  )
+{
+  int ncx = grid->ncx;
+  int ntx = grid->ntx;
+  int nt = ntx * grid->nty;
+  int *cell = (int *)malloc(sizeof(int) * n);
+  int *perm = (int *)malloc(sizeof(int) * n);
+  int *start = (int *)malloc(sizeof(int) * (nt+1));
+  double *t = (double *)malloc(sizeof(double) * n);
+  double *u = (double *)malloc(sizeof(double) * n);
+
+// locate cells
+#pragma omp parallel for
+  for (int k = 0; k < n; k++) {
+    int i, j;
+    locate(grid, xo[k], yo[k], &i, &j, &t[k], &u[k]);
+    cell[k] = (j + grid->joff)*ncx + i;
+  }
+// counting sort of the targets by tile
+  for (int it = 0; it < nt+1; it++) {
+    start[it] = 0;
+  }
+  for (int k = 0; k < n; k++) {
+    int i = cell[k] % ncx;
+    int j = cell[k] / ncx;
+    start[(j/TILE)*ntx + i/TILE + 1]++;
+  }
+  for (int it = 0; it < nt; it++) {
+    start[it+1] += start[it];
+  }
+  for (int k = 0; k < n; k++) {
+    int i = cell[k] % ncx;
+    int j = cell[k] / ncx;
+    perm[start[(j/TILE)*ntx + i/TILE]++] = k;
+  }
+  for (int it = nt; it > 0; it--) {
+    start[it] = start[it-1];
+  }
+  start[0] = 0;
+// evaluate tile by tile
+#pragma omp parallel for schedule(dynamic)
+  for (int it = 0; it < nt; it++) {
+    if (start[it] == start[it+1]) {
+      continue;
+    }
+    if (!grid->ready[it]) {
+      build_tile(grid, it);
+    }
+    int i0 = (it % ntx) * TILE;
+    int j0 = (it / ntx) * TILE;
+    for (int l = start[it]; l < start[it+1]; l++) {
+      int k = perm[l];
+      int i = cell[k] % ncx;
+      int j = cell[k] / ncx;
+      fo[k] = eno_bicubic_interpolate(&grid->tile[it][16*((j-j0)*TILE+i-i0)], t[k], u[k]);
+    }
+  }
+  free(cell);
+  free(perm);
+  free(start);
+  free(t);
+  free(u);
+  return 0;
+}
+
+int eno_bicubic_grid_interpolate_multi /// interpolate nv interleaved variables at n points
+  (
+    eno_bicubic_grid_t *grid, ///< [in]  regridder providing the coordinates
+    int nv,                   ///< [in]  # of variables
+    double *f,                ///< [in]  f[ny*nx*nv], variable v at (i,j) in f[(j*nx+i)*nv+v]
+    double *sign,             ///< [in]  sign[nv] across the poles, -1 for vector components, NULL for scalars
+    bool mono,                ///< [in]  limit to the range of the corners of the cell
+    int n,                    ///< [in]  # of target points
+    double *xo,               ///< [in]  xo[n] target x
+    double *yo,               ///< [in]  yo[n] target y
+    double *fo                ///< [out] fo[n*nv], variable v at point k in fo[k*nv+v]
+  )
+{
+#pragma omp parallel
+  {
+    double *fs = (double *)malloc(sizeof(double) * 16 * nv);
+    double *cs = (double *)malloc(sizeof(double) * 16 * nv);
+#pragma omp for
+    for (int k = 0; k < n; k++) {
+      int i, j;
+      double t, u;
+      locate(grid, xo[k], yo[k], &i, &j, &t, &u);
+      double dx = xnode(grid, i+1) - xnode(grid, i);
+      double dy = ynode(grid, j+1) - ynode(grid, j);
+      int ic[4] = {i, i+1, i+1, i};
+      int jc[4] = {j, j, j+1, j+1};
+      for (int l = 0; l < 4; l++) {
+        for (int v = 0; v < nv; v++) {
+          double s = (sign == NULL) ? 1.0 : sign[v];
+          fs[ l    *nv+v] = node(grid, &f[v], nv, s, ic[l], jc[l]);
+          fs[(l+4) *nv+v] = diff_x(grid, &f[v], nv, s, ic[l], jc[l]) * dx;
+          fs[(l+8) *nv+v] = diff_y(grid, &f[v], nv, s, ic[l], jc[l]) * dy;
+          fs[(l+12)*nv+v] = diff_xy(grid, &f[v], nv, s, ic[l], jc[l]) * dx * dy;
+        }
+      }
+      eno_bicubic_coeff_batch(nv, fs, cs);
+      eno_bicubic_interpolate_multi(nv, cs, t, u, mono, &fo[k*nv]);
+    }
+    free(fs);
+    free(cs);
+  }
+  return 0;
+}
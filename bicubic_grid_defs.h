@@ -0,0 +1 @@
+#define TILE 16
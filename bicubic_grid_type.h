@@ -0,0 +1,14 @@
+typedef struct eno_bicubic_grid_t {
+  int nx, ny;
+  double *x, *y;
+  bool sphere;
+  double period;
+  double pole[2];
+  bool lazy;
+  double sign;
+  double *f, *fx, *fy, *fxy;
+  int ncx, ncy, joff;
+  int ntx, nty;
+  double **tile;
+  bool *ready;
+}
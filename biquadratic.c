@@ -18,7 +18,14 @@
  *
  * inv(A) is calculated with Octave code  biquadratic.m 
  *
+ * On a grid, eno_biquadratic_interpolate_grid() locates the 3-point stencil centred
+ * at the nearest node with eno_biquadratic_locate() and applies the tensor product
+ * of the quadratic Lagrange weights of eno_biquadratic_weights() to all variables,
+ * which equals the surface above on a uniform stencil.
+ *
  */
+#include <stdlib.h>
+#include <math.h>
 #include "biquadratic.h"
 
 /// calculate coeffients from the give function values and the derivatives
@@ -36,24 +43,47 @@ void eno_biquadratic_coeff
                    */
   )
 {
-  double a[9*9] = {
-     1,   0,   0,   0,   0,   0,   0,   0,   0,
-    -3,   0,   0,   0,   0,   0,  -1,   4,   0,
-     2,   0,   0,   0,   0,   0,   2,  -4,   0,
-    -3,   4,  -1,   0,   0,   0,   0,   0,   0,
-     9, -12,   3,  -4,   1,  -4,   3, -12,  16,
-    -6,   8,  -2,   4,  -2,   8,  -6,  12, -16,
-     2,  -4,   2,   0,   0,   0,   0,   0,  -0,
-    -6,  12,  -6,   8,  -2,   4,  -2,   8, -16,
-     4,  -8,   4,  -8,   4,  -8,   4,  -8,  16
-};
-
-    for (int i = 0; i < 9; i++) {
-      c[i] = 0.0;
-      for (int j = 0; j < 9; j++) {
-        c[i] = c[i] + a[9*i+j] * f[j];
-      }
+  eno_biquadratic_coeff_batch(1, f, c);
+}
+
+void eno_biquadratic_coeff_batch /// calculate coefficients of n cells at once
+  (
+    int n,     /**< [in]  # of cells */
+    double *f, /**< [in]  f[9*n] as in eno_biquadratic_coeff() with cells fastest:
+                *         element l of cell k in f[l*n+k]
+                */
+    double *c  /**< [out] c[9*n] biquadratic coefficients with cells fastest */
+  )
+{
+/*
+ * inv(A) is the tensor product of the quadratic through (0, 1/2, 1)
+ * a0 = p0, a1 = -3p0+4ph-p1, a2 = 2p0-4ph+2p1
+ * applied in u and then in t.
+ */
+  static const int iu[3][3] = { // values at u = 0, 1/2, 1 for
+    {0, 7, 6},                  // t = 0
+    {1, 8, 5},                  // t = 1/2
+    {2, 3, 4}                   // t = 1
+  };
+
+#pragma omp simd
+  for (int k = 0; k < n; k++) {
+    double b[3][3];
+
+    for (int m = 0; m < 3; m++) {
+      double p0 = f[iu[m][0]*n+k];
+      double ph = f[iu[m][1]*n+k];
+      double p1 = f[iu[m][2]*n+k];
+      b[m][0] = p0;
+      b[m][1] = -3.0*p0+4.0*ph-p1;
+      b[m][2] =  2.0*p0-4.0*ph+2.0*p1;
     }
+    for (int j = 0; j < 3; j++) {
+      c[(    j)*n+k] = b[0][j];
+      c[(3 + j)*n+k] = -3.0*b[0][j]+4.0*b[1][j]-b[2][j];
+      c[(6 + j)*n+k] =  2.0*b[0][j]-4.0*b[1][j]+2.0*b[2][j];
+    }
+  }
 }
 
 double eno_biquadratic_interpolate /// interpolate at (t,u) using c[]
@@ -115,3 +145,154 @@ double eno_biquadratic_interpolate_xy /// interpolate xy-derivative at (t,u) usi
   }
   return fi;
 }
+
+void eno_biquadratic_interpolate_fused /// interpolate value and derivatives at (t,u) in one pass
+  (
+    double c[9], ///< [in]  coefficents obtained by eno_biquadratic_coeff()
+    double t,    ///< [in]  desired point in \f$x\f$
+    double u,    ///< [in]  desired point in \f$y\f$
+    double *f,   ///< [out] \f$f\f$, skipped if NULL
+    double *fx,  ///< [out] \f$f_x\f$, skipped if NULL
+    double *fy,  ///< [out] \f$f_y\f$, skipped if NULL
+    double *fxy  ///< [out] \f$f_{xy}\f$, skipped if NULL
+  )
+{
+  eno_biquadratic_interpolate_batch(1, c, &t, &u, f, fx, fy, fxy);
+}
+
+void eno_biquadratic_interpolate_batch /// interpolate value and derivatives at n points
+  (
+    int n,       ///< [in]  # of points
+    double *c,   ///< [in]  c[9*n] coefficients of the cell of each point, points fastest
+    double *t,   ///< [in]  t[n] desired points in \f$x\f$
+    double *u,   ///< [in]  u[n] desired points in \f$y\f$
+    double *f,   ///< [out] f[n] \f$f\f$, skipped if NULL
+    double *fx,  ///< [out] fx[n] \f$f_x\f$, skipped if NULL
+    double *fy,  ///< [out] fy[n] \f$f_y\f$, skipped if NULL
+    double *fxy  ///< [out] fxy[n] \f$f_{xy}\f$, skipped if NULL
+  )
+{
+#pragma omp simd
+  for (int k = 0; k < n; k++) {
+    double tk = t[k];
+    double uk = u[k];
+    double p = 0.0, px = 0.0, py = 0.0, pxy = 0.0;
+
+// Horner in t of the polynomials in u and their u-derivatives;
+// the t-derivatives are accumulated before p and py are updated
+    for (int i=2; i>=0; i--) {
+      double a  = (c[(3*i+2)*n+k]*uk+c[(3*i+1)*n+k])*uk+c[3*i*n+k];
+      double ay = 2.0*c[(3*i+2)*n+k]*uk+c[(3*i+1)*n+k];
+      px  = tk*px+p;
+      pxy = tk*pxy+py;
+      p   = tk*p+a;
+      py  = tk*py+ay;
+    }
+    if (f != NULL) {
+      f[k] = p;
+    }
+    if (fx != NULL) {
+      fx[k] = px;
+    }
+    if (fy != NULL) {
+      fy[k] = py;
+    }
+    if (fxy != NULL) {
+      fxy[k] = pxy;
+    }
+  }
+}
+
+void eno_biquadratic_interpolate_multi /// interpolate nv variables of one cell at (t,u)
+  (
+    int nv,    ///< [in]  # of variables
+    double *c, /**< [in]  c[9*nv] coefficients by eno_biquadratic_coeff_batch() with
+                *         variables fastest: coefficient l of variable v in c[l*nv+v]
+                */
+    double t,  ///< [in]  desired point in \f$x\f$
+    double u,  ///< [in]  desired point in \f$y\f$
+    double *f  ///< [out] f[nv] interpolated values
+  )
+{
+  double b[9] = {1.0, u, u*u, t, t*u, t*u*u, t*t, t*t*u, t*t*u*u};
+
+#pragma omp simd
+  for (int v = 0; v < nv; v++) {
+    double fi = 0.0;
+    for (int l = 0; l < 9; l++) {
+      fi += b[l]*c[l*nv+v];
+    }
+    f[v] = fi;
+  }
+}
+
+int eno_biquadratic_locate /// find the first node of the 3-point stencil centred at the node nearest to x
+  (
+    double *xa, ///< [in] xa[n] ascending or descending
+    int n,      ///< [in] # of nodes, n >= 3
+    double x    ///< [in] target
+  )
+{
+  int i = MAX(0, MIN(n-2, eno_search_bisection(xa, n, x)));
+  if (fabs(x - xa[i+1]) < fabs(x - xa[i])) {
+    i++;
+  }
+  return MAX(0, MIN(n-3, i-1));
+}
+
+void eno_biquadratic_weights /// calculate 1-D quadratic Lagrange weights of nodes i..i+2
+  (
+    double *xa, ///< [in]  xa[n] ascending or descending
+    int i,      ///< [in]  first node of the stencil by eno_biquadratic_locate()
+    double x,   ///< [in]  target
+    double w[3] ///< [out] weights of f(x_i), f(x_{i+1}), f(x_{i+2})
+  )
+{
+  double d0 = x - xa[i];
+  double d1 = x - xa[i+1];
+  double d2 = x - xa[i+2];
+
+  w[0] = d1*d2/((xa[i]-xa[i+1])*(xa[i]-xa[i+2]));
+  w[1] = d0*d2/((xa[i+1]-xa[i])*(xa[i+1]-xa[i+2]));
+  w[2] = d0*d1/((xa[i+2]-xa[i])*(xa[i+2]-xa[i+1]));
+}
+
+int eno_biquadratic_interpolate_grid /// interpolate nv interleaved variables on a grid at n points
+  (
+    int nx,     ///< [in]  # of points in x, nx >= 3
+    int ny,     ///< [in]  # of points in y, ny >= 3
+    double *x,  ///< [in]  x[nx] ascending or descending
+    double *y,  ///< [in]  y[ny] ascending or descending
+    int nv,     ///< [in]  # of variables
+    double *f,  ///< [in]  f[ny*nx*nv], variable v at (i,j) in f[(j*nx+i)*nv+v]
+    int n,      ///< [in]  # of target points
+    double *xo, ///< [in]  xo[n] target x
+    double *yo, ///< [in]  yo[n] target y
+    double *fo  ///< [out] fo[n*nv], variable v at point k in fo[k*nv+v]
+  )
+{
+#pragma omp parallel for
+  for (int k = 0; k < n; k++) {
+    int i = eno_biquadratic_locate(x, nx, xo[k]);
+    int j = eno_biquadratic_locate(y, ny, yo[k]);
+    double wx[3], wy[3];
+    double *fk = &fo[k*nv];
+
+    eno_biquadratic_weights(x, i, xo[k], wx);
+    eno_biquadratic_weights(y, j, yo[k], wy);
+    for (int v = 0; v < nv; v++) {
+      fk[v] = 0.0;
+    }
+    for (int b = 0; b < 3; b++) {
+      for (int a = 0; a < 3; a++) {
+        double w = wx[a] * wy[b];
+        double *fl = &f[((j+b)*nx+i+a)*nv];
+#pragma omp simd
+        for (int v = 0; v < nv; v++) {
+          fk[v] += w*fl[v];
+        }
+      }
+    }
+  }
+  return 0;
+}
@@ -13,13 +13,37 @@
  * The given function values and the derivatives matches those of the interpolated curve
  * at two points to determine 4 coefficients.
  * Cubic Hermite interpolation is an 1D version of bicubic interpolation.
+ * eno_cubic_hermite_weights() gives the interpolant as weights of the values
+ * at the nodes \f$i-1,\dots,i+2\f$ with the derivatives estimated by centred differences.
+ *
+ * A spline through the whole column is built by estimating the derivatives at
+ * the nodes with \f$h_k = x_{k+1}-x_k\f$ and \f$\Delta_k = (f_{k+1}-f_k)/h_k\f$.
+ *
+ * - HERMITE_FD: three-point finite difference
+ *   \f$d_k = (h_k\Delta_{k-1}+h_{k-1}\Delta_k)/(h_{k-1}+h_k)\f$,
+ *   one-sided three-point at the ends, exact for quadratics.
+ * - HERMITE_CR: Catmull-Rom \f$d_k = (f_{k+1}-f_{k-1})/(x_{k+1}-x_{k-1})\f$,
+ *   \f$\Delta\f$ at the ends.
+ * - HERMITE_PCHIP: weighted harmonic mean of \f$\Delta_{k-1}\f$ and \f$\Delta_k\f$,
+ *   zero at extrema, which preserves monotonicity (Fritsch and Butland 1984).
+ * - HERMITE_SPLINE: natural cubic spline with continuous second derivatives,
+ *   a tridiagonal system solved by the Thomas algorithm.
+ *
+ * Columns are stored level by level, \f$f_k\f$ of column c is f[k*ncol+c],
+ * so that the loops over columns are innermost and vectorize.
+ * Columns are processed in blocks of COLUMN_BLOCK in parallel.
  *
  * # Reference
  *
  * - [Cubic Hermite spline](http://en.wikipedia.org/wiki/Cubic_Hermite_spline)
  * - [Hermite Curve Interpolation](http://www.cubic.org/docs/hermite.htm)
+ * - Fritsch, F. N. and J. Butland, 1984: A method for constructing local monotone
+ *   piecewise cubic interpolants. SIAM J. Sci. Stat. Comput., 5, 300--304.
  *
  */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
 #include "cubic_hermite.h"
 
 /// calculate coeffients from the give function values and the derivatives
@@ -53,4 +77,199 @@ double eno_cubic_hermite_interpolate_x /// interpolate derivative at t using c[]
   )
 {
   return c[1]+(2.0*c[2]+3.0*c[3]*t)*t;
-} 
+}
+
+void eno_cubic_hermite_weights /// calculate weights of nodes i-1..i+2 with centred differences
+  (
+    double *xa, ///< [in]  xa[n] ascending or descending
+    int n,      ///< [in]  # of nodes, n >= 2
+    int i,      ///< [in]  cell, 0 <= i <= n-2
+    double t,   ///< [in]  desired point \f$0 \le t \le 1\f$ in the cell
+    double w[4] /**< [out] weights of f(x_{i-1})..f(x_{i+2}), zero outside the grid;
+                  *  the derivatives are one-sided at the ends
+                  */
+  )
+{
+  double dx = xa[i+1] - xa[i];
+  double h0 = 1.0 + (-3.0 + 2.0*t)*t*t;
+  double h1 = (3.0 - 2.0*t)*t*t;
+  double g0 = t*(1.0 + (-2.0 + t)*t);
+  double g1 = (-1.0 + t)*t*t;
+  int im = MAX(i-1, 0);
+  int ip = MIN(i+2, n-1);
+  double d0 = g0 * dx / (xa[i+1] - xa[im]);
+  double d1 = g1 * dx / (xa[ip] - xa[i]);
+
+  w[0] = 0.0;
+  w[1] = h0;
+  w[2] = h1;
+  w[3] = 0.0;
+  w[im-i+1] -= d0;
+  w[2] += d0;
+  w[1] -= d1;
+  w[ip-i+1] += d1;
+}
+
+/// derivative at an end with the one-sided three-point formula, h0 next to the end
+static double end_deriv(double h0, double h1, double s0, double s1, bool pchip)
+{
+  double d = ((2.0*h0 + h1)*s0 - h0*s1) / (h0 + h1);
+
+  if (pchip) {
+    if (d*s0 <= 0.0) {
+      d = 0.0;
+    } else if (s0*s1 <= 0.0 && fabs(d) > fabs(3.0*s0)) {
+      d = 3.0*s0;
+    }
+  }
+  return d;
+}
+
+int eno_cubic_hermite_column_deriv /// estimate derivatives at the nodes of ncol columns
+  (
+    int method, ///< [in]  HERMITE_FD, HERMITE_CR, HERMITE_PCHIP or HERMITE_SPLINE
+    int nlev,   ///< [in]  # of nodes in a column, nlev >= 3
+    int ncol,   ///< [in]  # of columns
+    double *x,  ///< [in]  x[nlev*ncol] ascending or descending in each column
+    double *f,  ///< [in]  f[nlev*ncol]
+    double *d   ///< [out] d[nlev*ncol] \f$df/dx\f$
+  )
+{
+  double *w = NULL;
+
+  if (method == HERMITE_SPLINE) {
+    w = (double *)malloc(sizeof(double) * nlev * ncol);
+  }
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    for (int k = 0; k < nlev; k++) {
+      int km = MAX(k-1, 0);
+      int kp = MIN(k+1, nlev-1);
+      double *xm = &x[km*ncol], *x0 = &x[k*ncol], *xp = &x[kp*ncol];
+      double *fm = &f[km*ncol], *f0 = &f[k*ncol], *fp = &f[kp*ncol];
+      double *dk = &d[k*ncol];
+      switch (method) {
+      case HERMITE_CR:
+        for (int c = c0; c < c1; c++) {
+          dk[c] = (fp[c] - fm[c]) / (xp[c] - xm[c]);
+        }
+        break;
+      case HERMITE_FD:
+      case HERMITE_PCHIP:
+        if (k == 0 || k == nlev-1) {
+          int s = (k == 0) ? 1 : -1;
+          double *x1 = &x[(k+s)*ncol], *x2 = &x[(k+2*s)*ncol];
+          double *f1 = &f[(k+s)*ncol], *f2 = &f[(k+2*s)*ncol];
+          for (int c = c0; c < c1; c++) {
+            double h0 = x1[c] - x0[c], h1 = x2[c] - x1[c];
+            dk[c] = end_deriv(h0, h1, (f1[c] - f0[c])/h0, (f2[c] - f1[c])/h1,
+              method == HERMITE_PCHIP);
+          }
+        } else if (method == HERMITE_FD) {
+          for (int c = c0; c < c1; c++) {
+            double hm = x0[c] - xm[c], hp = xp[c] - x0[c];
+            double sm = (f0[c] - fm[c])/hm, sp = (fp[c] - f0[c])/hp;
+            dk[c] = (hp*sm + hm*sp) / (hm + hp);
+          }
+        } else {
+          for (int c = c0; c < c1; c++) {
+            double hm = x0[c] - xm[c], hp = xp[c] - x0[c];
+            double sm = (f0[c] - fm[c])/hm, sp = (fp[c] - f0[c])/hp;
+            double w1 = 2.0*hp + hm, w2 = hp + 2.0*hm;
+            dk[c] = (sm*sp > 0.0) ? (w1 + w2) / (w1/sm + w2/sp) : 0.0;
+          }
+        }
+        break;
+      case HERMITE_SPLINE:
+// forward elimination of
+// h_k d_{k-1} + 2(h_{k-1}+h_k) d_k + h_{k-1} d_{k+1} = 3(h_k s_{k-1} + h_{k-1} s_k)
+// with 2 d_0 + d_1 = 3 s_0 and d_{n-2} + 2 d_{n-1} = 3 s_{n-2}
+        for (int c = c0; c < c1; c++) {
+          double hm = x0[c] - xm[c], hp = xp[c] - x0[c];
+          double sm = (k > 0) ? (f0[c] - fm[c])/hm : 0.0;
+          double sp = (k < nlev-1) ? (fp[c] - f0[c])/hp : 0.0;
+          double a, b, u, r;
+          if (k == 0) {
+            a = 0.0; b = 2.0; u = 1.0; r = 3.0*sp;
+          } else if (k == nlev-1) {
+            a = 1.0; b = 2.0; u = 0.0; r = 3.0*sm;
+          } else {
+            a = hp; b = 2.0*(hm + hp); u = hm; r = 3.0*(hp*sm + hm*sp);
+          }
+          if (k > 0) {
+            b -= a * w[(k-1)*ncol+c];
+            r -= a * d[(k-1)*ncol+c];
+          }
+          w[k*ncol+c] = u / b;
+          dk[c] = r / b;
+        }
+        break;
+      }
+    }
+    if (method == HERMITE_SPLINE) {
+      for (int k = nlev-2; k >= 0; k--) {
+        for (int c = c0; c < c1; c++) {
+          d[k*ncol+c] -= w[k*ncol+c] * d[(k+1)*ncol+c];
+        }
+      }
+    }
+  }
+  free(w);
+  return 0;
+}
+
+/// interval 0..n-2 of a column with stride s containing v, linear search from i
+static int search_column(double *y, int s, int n, double v, int i)
+{
+  double sg = SIGN(y[(n-1)*s] - y[0]);
+
+  while (i > 0 && sg*(v - y[i*s]) < 0.0) {
+    i--;
+  }
+  while (i < n-2 && sg*(v - y[(i+1)*s]) >= 0.0) {
+    i++;
+  }
+  return i;
+}
+
+int eno_cubic_hermite_column_interpolate /// interpolate ncol columns at nt targets each
+  (
+    int nlev,   ///< [in]  # of nodes in a column, nlev >= 2
+    int ncol,   ///< [in]  # of columns
+    double *x,  ///< [in]  x[nlev*ncol] ascending or descending in each column
+    double *f,  ///< [in]  f[nlev*ncol]
+    double *d,  ///< [in]  d[nlev*ncol] derivatives by eno_cubic_hermite_column_deriv()
+    int nt,     ///< [in]  # of targets in a column
+    double *xt, ///< [in]  xt[nt*ncol] targets, the end intervals are extended outside
+    double *ft  ///< [out] ft[nt*ncol]
+  )
+{
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    int idx[COLUMN_BLOCK];
+    for (int c = c0; c < c1; c++) {
+      idx[c-c0] = 0;
+    }
+    for (int l = 0; l < nt; l++) {
+      double *xl = &xt[l*ncol];
+// locate, starting from the interval of the previous target
+      for (int c = c0; c < c1; c++) {
+        idx[c-c0] = search_column(&x[c], ncol, nlev, xl[c], idx[c-c0]);
+      }
+// evaluate
+      for (int c = c0; c < c1; c++) {
+        int k = idx[c-c0];
+        double h = x[(k+1)*ncol+c] - x[k*ncol+c];
+        double t = (xl[c] - x[k*ncol+c]) / h;
+        double f0 = f[k*ncol+c], f1 = f[(k+1)*ncol+c];
+        double d0 = h*d[k*ncol+c], d1 = h*d[(k+1)*ncol+c];
+        double c2 = 3.0*(f1 - f0) - 2.0*d0 - d1;
+        double c3 = 2.0*(f0 - f1) + d0 + d1;
+        ft[l*ncol+c] = f0 + (d0 + (c2 + c3*t)*t)*t;
+      }
+    }
+  }
+  return 0;
+}
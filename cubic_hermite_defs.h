@@ -0,0 +1,5 @@
+#define HERMITE_FD     0
+#define HERMITE_CR     1
+#define HERMITE_PCHIP  2
+#define HERMITE_SPLINE 3
+#define COLUMN_BLOCK   256
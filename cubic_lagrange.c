@@ -23,12 +23,22 @@
  *                     (x_i-x)P_{(i+1)(i+2)...(i+m)}}{x_i-x_{i+m}}
  * \f]
  *
+ * On a fixed grid the barycentric weights of each stencil
+ * \f[
+ * w_i = \prod_{m=0,m\neq i}^3\frac{1}{x_i-x_m}
+ * \f]
+ * are computed once by eno_cubic_lagrange_bary_init(), so that
+ * \f$l_i(x) = w_i\prod_{m\neq i}(x-x_m)\f$ costs only multiplications.
+ * eno_cubic_lagrange_bary() evaluates the weights once per target
+ * and applies them to all columns sharing the grid.
+ *
  * # Reference
  *
  * - [Lagrange polynomial](http://en.wikipedia.org/wiki/Lagrange_polynomial)
  * - [Neville's algorithm](http://en.wikipedia.org/wiki/Neville's_algorithm)
  */
-#include "cubic_hermite.h"
+#include <stdlib.h>
+#include "cubic_lagrange.h"
 
 double eno_cubic_lagrange
   (
@@ -67,3 +77,73 @@ double eno_cubic_lagrange
 
   return ((x - xa[3]) * y012 + (xa[0] - x) * y123) / (xa[0] - xa[3]);
 }
+
+void eno_cubic_lagrange_weights /// calculate weights l_i(x) of f(x_i)
+  (
+    double xa[4], ///< [in]  x_i
+    double x,     ///< [in]  x
+    double w[4]   ///< [out] \f$l_i(x)\f$, \f$p(x) = \sum_i l_i(x)y_i\f$
+  )
+{
+  for (int i = 0; i < 4; i++) {
+    w[i] = 1.0;
+    for (int m = 0; m < 4; m++) {
+      if (m != i) {
+        w[i] *= (x - xa[m]) / (xa[i] - xa[m]);
+      }
+    }
+  }
+}
+
+int eno_cubic_lagrange_bary_init /// precompute barycentric weights of all stencils of a grid
+  (
+    int n,     ///< [in]  # of nodes, n >= 4
+    double *x, ///< [in]  x[n] ascending or descending
+    double *wb ///< [out] wb[4*(n-3)] weights of the stencil starting at s in wb[4*s..4*s+3]
+  )
+{
+  for (int s = 0; s < n-3; s++) {
+    for (int i = 0; i < 4; i++) {
+      double p = 1.0;
+      for (int m = 0; m < 4; m++) {
+        if (m != i) {
+          p *= x[s+i] - x[s+m];
+        }
+      }
+      wb[4*s+i] = 1.0 / p;
+    }
+  }
+  return 0;
+}
+
+int eno_cubic_lagrange_bary /// interpolate ncol columns on a fixed grid at nt targets
+  (
+    int n,      ///< [in]  # of nodes, n >= 4
+    double *x,  ///< [in]  x[n] ascending or descending
+    double *wb, ///< [in]  wb[4*(n-3)] by eno_cubic_lagrange_bary_init()
+    int nt,     ///< [in]  # of targets
+    double *xt, ///< [in]  xt[nt] targets
+    int ncol,   ///< [in]  # of columns
+    double *f,  ///< [in]  f[n*ncol], f(x_k) of column c in f[k*ncol+c]
+    double *ft  ///< [out] ft[nt*ncol]
+  )
+{
+#pragma omp parallel for
+  for (int l = 0; l < nt; l++) {
+    int s = MAX(0, MIN(n-4, eno_search_bisection(x, n, xt[l]) - 1));
+    double d0 = xt[l] - x[s], d1 = xt[l] - x[s+1];
+    double d2 = xt[l] - x[s+2], d3 = xt[l] - x[s+3];
+    double d01 = d0*d1, d23 = d2*d3;
+    double w0 = wb[4*s]   * d1*d23;
+    double w1 = wb[4*s+1] * d0*d23;
+    double w2 = wb[4*s+2] * d01*d3;
+    double w3 = wb[4*s+3] * d01*d2;
+    double *f0 = &f[s*ncol], *f1 = &f[(s+1)*ncol];
+    double *f2 = &f[(s+2)*ncol], *f3 = &f[(s+3)*ncol];
+    double *fl = &ft[l*ncol];
+    for (int c = 0; c < ncol; c++) {
+      fl[c] = w0*f0[c] + w1*f1[c] + w2*f2[c] + w3*f3[c];
+    }
+  }
+  return 0;
+}
@@ -1,5 +1,22 @@
 /// emath.c: Math functions missing in C
+/*
+ * elog() and elogv() reduce x to \f$2^e m\f$ with \f$1/\sqrt{2}\le m<\sqrt{2}\f$ by bit operations
+ * and sum the series of \f$\ln m = 2\,\mathrm{artanh}\,s\f$, \f$s = (m-1)/(m+1)\f$, \f$|s| < 0.172\f$.
+ * Without branches or table lookup, the loop over the array vectorizes.
+ * ELOG_FULL takes terms up to \f$s^{21}\f$ for double precision and
+ * ELOG_FAST up to \f$s^{11}\f$ for a relative error below \f$10^{-10}\f$.
+ * Zero, negative, subnormal, infinite and NaN arguments are not handled.
+ *
+ * eexp() and eexpv() reduce x to \f$k\ln 2 + r\f$ with \f$|r|\le\ln 2/2\f$,
+ * rounding \f$x/\ln 2\f$ by adding and subtracting \f$1.5\times 2^{52}\f$,
+ * and build \f$2^k\f$ from its exponent bits.
+ * EEXP_FULL sums the Taylor series of \f$e^r\f$ up to \f$r^{13}\f$ for double precision and
+ * EEXP_FAST up to \f$r^9\f$ for a relative error below \f$10^{-10}\f$.
+ * The argument must satisfy \f$|x| < 708\f$.
+ */
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include "emath.h"
 
@@ -51,3 +68,172 @@ double ipow(double x, int n)
   } while (n); // n > 0
   return y;
 }
+
+/// split x = 2^e m with sqrt(1/2) <= m < sqrt(2) and return s = (m-1)/(m+1)
+static double log_reduce(double x, double *e)
+{
+  uint64_t u;
+
+  memcpy(&u, &x, sizeof(u));
+  int64_t ie = (int64_t)((u >> 52) & 0x7ff) - 1023;
+  u = (u & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+  double m;
+  memcpy(&m, &u, sizeof(m));
+  bool big = m > M_SQRT2;
+  m = big ? 0.5*m : m;
+  *e = (double)(ie + big);
+  return (m - 1.0) / (m + 1.0);
+}
+
+/// \f$\ln x = e\ln 2 + 2(s + s^3/3 + \cdots + s^{21}/21)\f$
+static double log_full(double x)
+{
+  const double ln2hi = 6.93147180369123816490e-01;
+  const double ln2lo = 1.90821492927058770002e-10;
+  double e;
+  double s = log_reduce(x, &e);
+  double z = s*s;
+  double p = 1.0/21.0;
+  p = 1.0/19.0 + z*p;
+  p = 1.0/17.0 + z*p;
+  p = 1.0/15.0 + z*p;
+  p = 1.0/13.0 + z*p;
+  p = 1.0/11.0 + z*p;
+  p = 1.0/9.0 + z*p;
+  p = 1.0/7.0 + z*p;
+  p = 1.0/5.0 + z*p;
+  p = 1.0/3.0 + z*p;
+  return e*ln2hi + (e*ln2lo + 2.0*s*z*p) + 2.0*s;
+}
+
+/// \f$\ln x = e\ln 2 + 2(s + s^3/3 + \cdots + s^{11}/11)\f$, relative error below 1e-10
+static double log_fast(double x)
+{
+  double e;
+  double s = log_reduce(x, &e);
+  double z = s*s;
+  double p = 1.0/11.0;
+  p = 1.0/9.0 + z*p;
+  p = 1.0/7.0 + z*p;
+  p = 1.0/5.0 + z*p;
+  p = 1.0/3.0 + z*p;
+  return e*M_LN2 + 2.0*s*(1.0 + z*p);
+}
+
+double elog /// natural logarithm of positive normal x without branches
+  (
+    double x, /// < [in] x
+    int acc   /// < [in] ELOG_FULL: double precision, ELOG_FAST: 1e-10
+  )
+{
+  return (acc == ELOG_FAST) ? log_fast(x) : log_full(x);
+}
+
+int elogv /// natural logarithm of n positive normal numbers, vectorizable
+  (
+    int n,     /// < [in] # of elements
+    double *x, /// < [in] x[n]
+    double *y, /// < [out] y[n] log(x), may be x
+    int acc    /// < [in] ELOG_FULL: double precision, ELOG_FAST: 1e-10
+  )
+{
+  switch (acc) {
+  case ELOG_FAST:
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+      y[i] = log_fast(x[i]);
+    }
+    break;
+  case ELOG_FULL:
+  default:
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+      y[i] = log_full(x[i]);
+    }
+  }
+  return 0;
+}
+
+/// split x = k ln2 + r with |r| <= ln2/2 and return 2^k
+static double exp_reduce(double x, double *r)
+{
+  const double shift = 6755399441055744.0; // 1.5*2^52
+  const double ln2hi = 6.93147180369123816490e-01;
+  const double ln2lo = 1.90821492927058770002e-10;
+  double k = (x*M_LOG2E + shift) - shift;
+  *r = (x - k*ln2hi) - k*ln2lo;
+  uint64_t u = (uint64_t)((int64_t)k + 1023) << 52;
+  double scale;
+  memcpy(&scale, &u, sizeof(scale));
+  return scale;
+}
+
+/// \f$e^x = 2^k(1 + r + r^2/2! + \cdots + r^{13}/13!)\f$
+static double exp_full(double x)
+{
+  double r;
+  double scale = exp_reduce(x, &r);
+  double p = 1.0 + r/13.0;
+  p = 1.0 + r*p/12.0;
+  p = 1.0 + r*p/11.0;
+  p = 1.0 + r*p/10.0;
+  p = 1.0 + r*p/9.0;
+  p = 1.0 + r*p/8.0;
+  p = 1.0 + r*p/7.0;
+  p = 1.0 + r*p/6.0;
+  p = 1.0 + r*p/5.0;
+  p = 1.0 + r*p/4.0;
+  p = 1.0 + r*p/3.0;
+  p = 1.0 + r*p/2.0;
+  return scale*(1.0 + r*p);
+}
+
+/// \f$e^x = 2^k(1 + r + \cdots + r^9/9!)\f$, relative error below 1e-10
+static double exp_fast(double x)
+{
+  double r;
+  double scale = exp_reduce(x, &r);
+  double p = 1.0 + r/9.0;
+  p = 1.0 + r*p/8.0;
+  p = 1.0 + r*p/7.0;
+  p = 1.0 + r*p/6.0;
+  p = 1.0 + r*p/5.0;
+  p = 1.0 + r*p/4.0;
+  p = 1.0 + r*p/3.0;
+  p = 1.0 + r*p/2.0;
+  return scale*(1.0 + r*p);
+}
+
+double eexp /// exponential of |x| < 708 without branches
+  (
+    double x, /// < [in] x
+    int acc   /// < [in] EEXP_FULL: double precision, EEXP_FAST: 1e-10
+  )
+{
+  return (acc == EEXP_FAST) ? exp_fast(x) : exp_full(x);
+}
+
+int eexpv /// exponential of n numbers |x| < 708, vectorizable
+  (
+    int n,     /// < [in] # of elements
+    double *x, /// < [in] x[n]
+    double *y, /// < [out] y[n] exp(x), may be x
+    int acc    /// < [in] EEXP_FULL: double precision, EEXP_FAST: 1e-10
+  )
+{
+  switch (acc) {
+  case EEXP_FAST:
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+      y[i] = exp_fast(x[i]);
+    }
+    break;
+  case EEXP_FULL:
+  default:
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+      y[i] = exp_full(x[i]);
+    }
+  }
+  return 0;
+}
@@ -4,3 +4,7 @@
 #define SIGN(X)  ((X) > 0 ? 1 : -1)
 #define EQV(X,Y) (((X) && (Y)) || (!(X) && !(Y)))
 #define XOR(X,Y) (((X) && !(Y)) || (!(X) && (Y)))
+#define ELOG_FULL 0
+#define ELOG_FAST 1
+#define EEXP_FULL 0
+#define EEXP_FAST 1
@@ -2,7 +2,16 @@
 /*
  * @file: extrapolate.c
  * @author: Takeshi Enomoto
+ *
+ * Functions with the suffix _grid extrapolate many columns stored level-major,
+ * x[k*ncol+c]. Only the targets marked in mask are computed and the others are
+ * left untouched. The marked columns of each level in a block of COLUMN_BLOCK
+ * are packed into a list, so that sparse targets scattered over the grid
+ * are evaluated in a vector loop with elogv() and constants set up once.
+ * The blend of the lapse rate over 2000--2500 m in eno_extrapolate_T()
+ * is written with MIN and MAX, which gives the same values without branches.
  */
+#include <stdbool.h>
 #include <math.h>
 #include "extrapolate.h"
 double calc_y
@@ -57,3 +66,109 @@ double eno_extrapolate_T /// extrapolate temperature
   double y = calc_y(gamma, sig);
   return Ts * (1.0 + (1.0 + (0.5 + y/6.0) * y) * y);
 }
+
+int eno_extrapolate_Ts_grid /// calculate surface temperature of ncol columns
+  (
+    int ncol,     /// < [in] # of columns
+    double *Tl,   /// < [in] Tl[ncol] full-level temperature just above the surface
+    double *sigl, /// < [in] sigl[ncol] full-level p/ps just above the surface
+    double *Ts    /// < [out] Ts[ncol] surface temperature
+  )
+{
+  const double rgg = eno_isa_dTdz(0) * eno_air_Rd / eno_earth_gravity;
+
+#pragma omp parallel for simd
+  for (int c = 0; c < ncol; c++) {
+    Ts[c] = Tl[c] * (1.0 + rgg*(sigl[c] - 1.0));
+  }
+  return 0;
+}
+
+/// pack marked columns c0 <= c < c1 of a level into idx and their log(sig) into lsig
+static int pack(int c0, int c1, double *sig, bool *mask, int *idx, double *lsig)
+{
+  int m = 0;
+
+  for (int c = c0; c < c1; c++) {
+    idx[m] = c;
+    m += mask[c];
+  }
+  for (int l = 0; l < m; l++) {
+    lsig[l] = sig[idx[l]];
+  }
+  elogv(m, lsig, lsig, ELOG_FULL);
+  return m;
+}
+
+int eno_extrapolate_z_grid /// extrapolate geopotential height of marked targets in ncol columns
+  (
+    int nlev,    /// < [in] # of target levels
+    int ncol,    /// < [in] # of columns
+    double *zs,  /// < [in] zs[ncol] surface geopotential height, m
+    double *Ts,  /// < [in] Ts[ncol] surface temperature
+    double *sig, /// < [in] sig[nlev*ncol] target p/ps
+    bool *mask,  /// < [in] mask[nlev*ncol] true below the surface
+    double *z    /// < [out] z[nlev*ncol] geopotential height of marked targets
+  )
+{
+  const double rdg = eno_air_Rd / eno_earth_gravity;
+  const double gamma = -eno_isa_dTdz(0);
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    int idx[COLUMN_BLOCK];
+    double lsig[COLUMN_BLOCK];
+    for (int k = 0; k < nlev; k++) {
+      int m = pack(c0, c1, &sig[k*ncol], &mask[k*ncol], idx, lsig);
+#pragma omp simd
+      for (int l = 0; l < m; l++) {
+        int c = idx[l];
+        double y = gamma * rdg * lsig[l];
+        z[k*ncol+c] = zs[c] - rdg * Ts[c] * lsig[l] * (1.0 + (0.5 + y / 0.6) * y);
+      }
+    }
+  }
+  return 0;
+}
+
+int eno_extrapolate_T_grid /// extrapolate temperature of marked targets in ncol columns
+  (
+    int nlev,    /// < [in] # of target levels
+    int ncol,    /// < [in] # of columns
+    double *zs,  /// < [in] zs[ncol] surface geopotential height, m
+    double *Ts,  /// < [in] Ts[ncol] surface temperature
+    double *sig, /// < [in] sig[nlev*ncol] target p/ps
+    bool *mask,  /// < [in] mask[nlev*ncol] true below the surface
+    double *T    /// < [out] T[nlev*ncol] temperature of marked targets
+  )
+{
+  const double rg = eno_air_Rd / eno_earth_gravity;
+  const double gamma0 = -eno_isa_dTdz(0);
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    int idx[COLUMN_BLOCK];
+    double lsig[COLUMN_BLOCK], gr[COLUMN_BLOCK];
+// lapse rate times Rd/g of each column, blended over high orography
+#pragma omp simd
+    for (int c = c0; c < c1; c++) {
+      double T1 = Ts[c] + gamma0 * zs[c];
+      double w = MIN(MAX((zs[c] - 2000.0)/(2500.0 - 2000.0), 0.0), 1.0);
+      double T0 = T1 + w*(MIN(T1, 298.0) - T1);
+      double gamma = (zs[c] > 2000.0) ? MAX(T0 - Ts[c], 0.0)/MAX(zs[c], 2000.0) : gamma0;
+      gr[c-c0] = gamma * rg;
+    }
+    for (int k = 0; k < nlev; k++) {
+      int m = pack(c0, c1, &sig[k*ncol], &mask[k*ncol], idx, lsig);
+#pragma omp simd
+      for (int l = 0; l < m; l++) {
+        int c = idx[l];
+        double y = gr[c-c0] * lsig[l];
+        T[k*ncol+c] = Ts[c] * (1.0 + (1.0 + (0.5 + y/6.0) * y) * y);
+      }
+    }
+  }
+  return 0;
+}
@@ -2,7 +2,27 @@
 /*
  * @file: moist.c
  * @author: Takeshi Enomoto
+ *
+ * Functions with the suffix _grid and the kernels below work on n points
+ * of any layout. The points are threaded in blocks of COLUMN_BLOCK;
+ * the arguments of exp and log are gathered in a block and evaluated by
+ * eexpv() and elogv() so that the loops vectorize.
+ * acc selects EEXP_FULL for double precision or EEXP_FAST for a relative
+ * error of about 1e-10 in each exp or log.
+ *
+ * Saturation vapour pressure over water is given by
+ * - MOIST_TETENS: \f$e_s = 610.78\exp[17.27(T-T_0)/(T-35.86)]\f$ Pa
+ * - MOIST_GOFF_GRATCH: Goff-Gratch equation with the steam point 373.16 K
+ *
+ * Dew point inverts the Tetens formula.
+ * Equivalent potential temperature follows Bolton (1980) eqs. (21) and (43)
+ * with the reference pressure 1000 hPa.
+ *
+ * # References
+ * - Bolton (1980) MWR
+ * - WMO (1988) Technical Regulations, WMO-No. 49
  */
+#include <math.h>
 #include "moist.h"
 
 /// calculate virtual temperature
@@ -15,3 +35,208 @@ double eno_moist_calc_Tv
   const double eps = eno_air_eps;
   return T*(1.0+(1.0-eps)/eps*q);
 }
+
+int eno_moist_calc_Tv_grid /// calculate virtual temperature of n points
+  (
+    int n,     /// < [in] # of points
+    double *T, /// < [in] T[n] temperature, K
+    double *q, /// < [in] q[n] specific humidity, kg/kg
+    double *Tv /// < [out] Tv[n] virtual temperature, K
+  )
+{
+  const double eps = eno_air_eps;
+  const double c = (1.0-eps)/eps;
+
+#pragma omp parallel for simd
+  for (int i = 0; i < n; i++) {
+    Tv[i] = T[i]*(1.0+c*q[i]);
+  }
+  return 0;
+}
+
+int eno_moist_calc_es /// calculate saturation vapour pressure over water of n points
+  (
+    int n,      /// < [in] # of points
+    int method, /// < [in] MOIST_TETENS or MOIST_GOFF_GRATCH
+    int acc,    /// < [in] EEXP_FULL or EEXP_FAST
+    double *T,  /// < [in] T[n] temperature, K
+    double *es  /// < [out] es[n] saturation vapour pressure, Pa
+  )
+{
+  const double T0 = eno_air_T0;
+  const double Tst = 373.16;
+  const double lnes0 = log(1013.246e2);
+  int lacc = (acc == EEXP_FAST) ? ELOG_FAST : ELOG_FULL;
+
+#pragma omp parallel for
+  for (int i0 = 0; i0 < n; i0 += COLUMN_BLOCK) {
+    int m = MIN(n, i0 + COLUMN_BLOCK) - i0;
+    double *Ti = &T[i0];
+    double *ei = &es[i0];
+    switch (method) {
+    case MOIST_GOFF_GRATCH: {
+      double lr[COLUMN_BLOCK], a[COLUMN_BLOCK], b[COLUMN_BLOCK];
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        double r = Tst/Ti[i];
+        lr[i] = r;
+        a[i] = M_LN10*11.344*(1.0 - 1.0/r);
+        b[i] = M_LN10*(-3.49149)*(r - 1.0);
+      }
+      elogv(m, lr, lr, lacc);
+      eexpv(m, a, a, acc);
+      eexpv(m, b, b, acc);
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        double r = Tst/Ti[i];
+        ei[i] = lnes0 + M_LN10*(-7.90298*(r - 1.0) - 1.3816e-7*(a[i] - 1.0)
+          + 8.1328e-3*(b[i] - 1.0)) + 5.02808*lr[i];
+      }
+      eexpv(m, ei, ei, acc);
+      break;
+    }
+    case MOIST_TETENS:
+    default:
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        ei[i] = TETENS_A*(Ti[i] - T0)/(Ti[i] - TETENS_B);
+      }
+      eexpv(m, ei, ei, acc);
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        ei[i] *= TETENS_E0;
+      }
+    }
+  }
+  return 0;
+}
+
+int eno_moist_calc_ws /// calculate saturation mixing ratio of n points
+  (
+    int n,      /// < [in] # of points
+    double *p,  /// < [in] p[n] pressure, Pa
+    double *es, /// < [in] es[n] saturation vapour pressure, Pa
+    double *ws  /// < [out] ws[n] saturation mixing ratio, kg/kg
+  )
+{
+  const double eps = eno_air_eps;
+
+#pragma omp parallel for simd
+  for (int i = 0; i < n; i++) {
+    ws[i] = eps*es[i]/(p[i] - es[i]);
+  }
+  return 0;
+}
+
+int eno_moist_calc_q /// calculate specific humidity from relative humidity of n points
+  (
+    int n,      /// < [in] # of points
+    double *p,  /// < [in] p[n] pressure, Pa
+    double *es, /// < [in] es[n] saturation vapour pressure, Pa
+    double *rh, /// < [in] rh[n] relative humidity, 0--1
+    double *q   /// < [out] q[n] specific humidity, kg/kg
+  )
+{
+  const double eps = eno_air_eps;
+
+#pragma omp parallel for simd
+  for (int i = 0; i < n; i++) {
+    double e = rh[i]*es[i];
+    q[i] = eps*e/(p[i] - (1.0-eps)*e);
+  }
+  return 0;
+}
+
+int eno_moist_calc_rh /// calculate relative humidity from specific humidity of n points
+  (
+    int n,      /// < [in] # of points
+    double *p,  /// < [in] p[n] pressure, Pa
+    double *es, /// < [in] es[n] saturation vapour pressure, Pa
+    double *q,  /// < [in] q[n] specific humidity, kg/kg
+    double *rh  /// < [out] rh[n] relative humidity, 0--1
+  )
+{
+  const double eps = eno_air_eps;
+
+#pragma omp parallel for simd
+  for (int i = 0; i < n; i++) {
+    double e = q[i]*p[i]/(eps + (1.0-eps)*q[i]);
+    rh[i] = e/es[i];
+  }
+  return 0;
+}
+
+int eno_moist_calc_Td /// calculate dew point of n points
+  (
+    int n,     /// < [in] # of points
+    int acc,   /// < [in] EEXP_FULL or EEXP_FAST
+    double *p, /// < [in] p[n] pressure, Pa
+    double *q, /// < [in] q[n] specific humidity > 0, kg/kg
+    double *Td /// < [out] Td[n] dew point, K
+  )
+{
+  const double eps = eno_air_eps;
+  const double T0 = eno_air_T0;
+  int lacc = (acc == EEXP_FAST) ? ELOG_FAST : ELOG_FULL;
+
+#pragma omp parallel for
+  for (int i0 = 0; i0 < n; i0 += COLUMN_BLOCK) {
+    int m = MIN(n, i0 + COLUMN_BLOCK) - i0;
+    double *di = &Td[i0];
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      double qi = q[i0+i];
+      di[i] = qi*p[i0+i]/(eps + (1.0-eps)*qi)/TETENS_E0;
+    }
+    elogv(m, di, di, lacc);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      double l = di[i];
+      di[i] = (TETENS_A*T0 - TETENS_B*l)/(TETENS_A - l);
+    }
+  }
+  return 0;
+}
+
+int eno_moist_calc_thetae /// calculate equivalent potential temperature of n points
+  (
+    int n,         /// < [in] # of points
+    int acc,       /// < [in] EEXP_FULL or EEXP_FAST
+    double *p,     /// < [in] p[n] pressure, Pa
+    double *T,     /// < [in] T[n] temperature, K
+    double *q,     /// < [in] q[n] specific humidity > 0, kg/kg
+    double *thetae /// < [out] thetae[n] equivalent potential temperature, K
+  )
+{
+  const double eps = eno_air_eps;
+  const double kappa = eno_air_kappa;
+  const double p00 = 1000.0e2;
+  int lacc = (acc == EEXP_FAST) ? ELOG_FAST : ELOG_FULL;
+
+#pragma omp parallel for
+  for (int i0 = 0; i0 < n; i0 += COLUMN_BLOCK) {
+    int m = MIN(n, i0 + COLUMN_BLOCK) - i0;
+    double lT[COLUMN_BLOCK], le[COLUMN_BLOCK], lp[COLUMN_BLOCK];
+    double *th = &thetae[i0];
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      double qi = q[i0+i];
+      lT[i] = T[i0+i];
+      le[i] = qi*p[i0+i]/(eps + (1.0-eps)*qi)*1.0e-2;
+      lp[i] = p00/p[i0+i];
+    }
+    elogv(m, lT, lT, lacc);
+    elogv(m, le, le, lacc);
+    elogv(m, lp, lp, lacc);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      double qi = q[i0+i];
+      double r = 1.0e3*qi/(1.0 - qi);
+      double TL = 2840.0/(3.5*lT[i] - le[i] - 4.805) + 55.0;
+      th[i] = lT[i] + kappa*(1.0 - 0.28e-3*r)*lp[i]
+        + (3.376/TL - 0.00254)*r*(1.0 + 0.81e-3*r);
+    }
+    eexpv(m, th, th, acc);
+  }
+  return 0;
+}
@@ -0,0 +1,5 @@
+#define MOIST_TETENS 0
+#define MOIST_GOFF_GRATCH 1
+#define TETENS_E0 610.78
+#define TETENS_A  17.27
+#define TETENS_B  35.86
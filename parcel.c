@@ -0,0 +1,254 @@
+/// Parcel ascent, LCL, LFC, CAPE and CIN
+/*
+ * @file: parcel.c
+ * @author: Takeshi Enomoto
+ *
+ * # Algorithm
+ *
+ * A parcel is lifted from the lowest full level \f$k=n\f$ of each column
+ * on hybrid levels stored level-major as by eno_sigmap_calc_p_grid(),
+ * x[k*ncol+c] with \f$1\le k\le n\f$.
+ *
+ * The temperature at the lifting condensation level is given by Bolton (1980) eq. (21)
+ * \f[
+ * T_L = \frac{2840}{3.5\ln T - \ln e - 4.805} + 55
+ * \f]
+ * with \f$e\f$ in hPa, and \f$p_L = p_{00}(T_L/\theta)^{1/\kappa}\f$.
+ * Below the LCL the parcel conserves \f$\theta\f$ and the mixing ratio \f$r\f$.
+ * Above the LCL the parcel is saturated and conserves the equivalent potential
+ * temperature \f$\theta_e\f$ of eno_moist_calc_thetae() (Bolton 1980 eq. 43)
+ * at the starting level, so that the pseudo-adiabat of the parcel and the
+ * \f$\theta_e\f$ reported by moist.c agree.
+ * The parcel temperature \f$T\f$ at \f$p\f$ solves
+ * \f$\theta_e(p,T,q_s(p,T)) = \theta_e\f$ with \f$e_s\f$ of MOIST_TETENS by eno_parcel_calc_T(),
+ * a fixed number of Newton iterations starting from the parcel temperature of the level below.
+ * The convergence is quadratic: four iterations from a guess within 10 K reduce
+ * the relative residual in \f$\theta_e\f$ below 1e-10, and eno_parcel_cape() uses four.
+ *
+ * The buoyancy \f$b = T_{v,\mathrm{parcel}} - T_{v,\mathrm{env}}\f$ is integrated as
+ * \f$R_d\int b\,d\ln p\f$ with the trapezoidal rule,
+ * splitting each layer at the zero crossing of \f$b\f$.
+ * The LFC is the first crossing to positive buoyancy at or above the LCL;
+ * CIN is the negative area below the LFC and CAPE the positive area
+ * between the LFC and the equilibrium level, where the column terminates.
+ * The integration stops at pmin, interpolating the buoyancy of the layer
+ * containing pmin linearly in \f$\ln p\f$.
+ * Columns without LFC have zero LFC pressure, CAPE and CIN.
+ *
+ * Columns are threaded in blocks of COLUMN_BLOCK and lifted in lockstep level by level,
+ * so that the loops vectorize with eexpv() and elogv() and no memory is allocated.
+ * A block stops when all its columns reach the equilibrium level or pmin.
+ *
+ * # Reference
+ * - Bolton (1980) MWR
+ */
+#include <stdbool.h>
+#include <math.h>
+#include "parcel.h"
+
+/// niter Newton iterations of T on the pseudo-adiabat ln(theta-e) = lnthe at p, also returning rs
+static void newton
+  (
+    int m,         ///< [in]    # of points
+    int acc,       ///< [in]    EEXP_FULL or EEXP_FAST
+    int niter,     ///< [in]    # of iterations
+    double *p,     ///< [in]    p[m] pressure, Pa
+    double *lp,    ///< [in]    lp[m] ln p
+    double *lnthe, ///< [in]    lnthe[m] ln theta-e
+    double *T,     ///< [inout] T[m] temperature, first guess on input
+    double *rs,    ///< [out]   rs[m] saturation mixing ratio at T
+    double *es,    ///< [out]   es[m] work
+    double *lt     ///< [out]   lt[m] work
+  )
+{
+  const double T0 = eno_air_T0;
+  const double eps = eno_air_eps;
+  const double kappa = eno_air_kappa;
+  const double lnp00 = log(1000.0e2);
+  const double lne0 = log(TETENS_E0*1.0e-2);
+  int lacc = (acc == EEXP_FAST) ? ELOG_FAST : ELOG_FULL;
+
+  for (int it = 0; it < niter; it++) {
+    eno_moist_calc_es(m, MOIST_TETENS, acc, T, es);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      lt[i] = T[i];
+    }
+    elogv(m, lt, lt, lacc);
+// f = ln(theta-e) - lnthe of eno_moist_calc_thetae() with q = qs and its derivative
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      double dlnes = TETENS_A*(T0 - TETENS_B)/((T[i] - TETENS_B)*(T[i] - TETENS_B));
+      double lnes = lne0 + TETENS_A*(T[i] - T0)/(T[i] - TETENS_B);
+      double r = eps*es[i]/(p[i] - es[i]);
+      double dr = r*p[i]/(p[i] - es[i])*dlnes;
+      double rg = 1.0e3*r, drg = 1.0e3*dr;
+      double d = 3.5*lt[i] - lnes - 4.805;
+      double TL = 2840.0/d + 55.0;
+      double dTL = -2840.0/(d*d)*(3.5/T[i] - dlnes);
+      double x = lnp00 - lp[i];
+      double g = 3.376/TL - 0.00254, dg = -3.376/(TL*TL)*dTL;
+      double h = rg*(1.0 + 0.81e-3*rg), dh = (1.0 + 1.62e-3*rg)*drg;
+      double f = lt[i] + kappa*(1.0 - 0.28e-3*rg)*x + g*h - lnthe[i];
+      double fp = 1.0/T[i] - kappa*0.28e-3*x*drg + dg*h + g*dh;
+      double dT = -f/fp;
+      T[i] += dT;
+      rs[i] = r + dr*dT;
+    }
+  }
+}
+
+int eno_parcel_calc_T /// calculate temperature on the pseudo-adiabat of thetae at p of n points
+  (
+    int n,          /// < [in]    # of points
+    int acc,        /// < [in]    EEXP_FULL or EEXP_FAST
+    int niter,      /// < [in]    # of Newton iterations
+    double *p,      /// < [in]    p[n] pressure, Pa
+    double *thetae, /// < [in]    thetae[n] equivalent potential temperature by eno_moist_calc_thetae(), K
+    double *T       /// < [inout] T[n] temperature, K, first guess on input
+  )
+{
+  int lacc = (acc == EEXP_FAST) ? ELOG_FAST : ELOG_FULL;
+
+#pragma omp parallel for
+  for (int i0 = 0; i0 < n; i0 += COLUMN_BLOCK) {
+    int m = MIN(n, i0 + COLUMN_BLOCK) - i0;
+    double lp[COLUMN_BLOCK], lnthe[COLUMN_BLOCK], rs[COLUMN_BLOCK], es[COLUMN_BLOCK], lt[COLUMN_BLOCK];
+    elogv(m, &p[i0], lp, lacc);
+    elogv(m, &thetae[i0], lnthe, lacc);
+    newton(m, acc, niter, &p[i0], lp, lnthe, &T[i0], rs, es, lt);
+  }
+  return 0;
+}
+
+int eno_parcel_cape /// calculate LCL, LFC, CAPE and CIN of parcels from the lowest level of ncol columns
+  (
+    int n,        /// < [in] # of layers
+    int ncol,     /// < [in] # of columns
+    double *pf,   /// < [in] pf[(n+1)*ncol] full-level pressure, Pa
+    double *T,    /// < [in] T[(n+1)*ncol] temperature, K
+    double *q,    /// < [in] q[(n+1)*ncol] specific humidity, > 0 at k = n, kg/kg
+    double pmin,  /// < [in] parcels are lifted up to pmin > 0, Pa
+    int acc,      /// < [in] EEXP_FULL or EEXP_FAST
+    double *plcl, /// < [out] plcl[ncol] pressure of LCL, Pa
+    double *plfc, /// < [out] plfc[ncol] pressure of LFC, Pa
+    double *cape, /// < [out] cape[ncol] CAPE, J/kg
+    double *cin   /// < [out] cin[ncol] CIN <= 0, J/kg
+  )
+{
+  const double Rd = eno_air_Rd;
+  const double eps = eno_air_eps;
+  const double kappa = eno_air_kappa;
+  const double lnp00 = log(1000.0e2);
+  const double lpmin = log(pmin);
+  const double cv = (1.0-eps)/eps;
+  const int niter = 4;
+  int lacc = (acc == EEXP_FAST) ? ELOG_FAST : ELOG_FULL;
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int m = MIN(ncol, c0 + COLUMN_BLOCK) - c0;
+    double r[COLUMN_BLOCK], lnth[COLUMN_BLOCK], lnthe[COLUMN_BLOCK], lpl[COLUMN_BLOCK];
+    double Tp[COLUMN_BLOCK], lp[COLUMN_BLOCK], lp0[COLUMN_BLOCK], b0[COLUMN_BLOCK];
+    double w[COLUMN_BLOCK], rs[COLUMN_BLOCK], es[COLUMN_BLOCK], lt[COLUMN_BLOCK];
+    int state[COLUMN_BLOCK]; // 0: below LFC, 1: above LFC, 2: terminated
+    double *Tn = &T[n*ncol+c0];
+    double *qn = &q[n*ncol+c0];
+    double *pn = &pf[n*ncol+c0];
+
+// LCL, conserved theta and theta-e
+    eno_moist_calc_thetae(m, acc, pn, Tn, qn, lnthe);
+    elogv(m, lnthe, lnthe, lacc);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      r[i] = qn[i]/(1.0 - qn[i]);
+      lnth[i] = Tn[i];
+      w[i] = qn[i]*pn[i]/(eps + (1.0-eps)*qn[i])*1.0e-2;
+      lp[i] = pn[i];
+    }
+    elogv(m, lnth, lnth, lacc);
+    elogv(m, w, w, lacc);
+    elogv(m, lp, lp, lacc);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      double TL = MIN(2840.0/(3.5*lnth[i] - w[i] - 4.805) + 55.0, Tn[i]);
+      lnth[i] += kappa*(lnp00 - lp[i]);
+      w[i] = TL;
+    }
+    elogv(m, w, w, lacc);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      lpl[i] = MIN(lnp00 + (w[i] - lnth[i])/kappa, lp[i]);
+      plcl[c0+i] = lpl[i];
+      plfc[c0+i] = 0.0;
+      cape[c0+i] = 0.0;
+      cin[c0+i] = 0.0;
+      state[i] = (lp[i] <= lpmin) ? 2 : 0;
+      Tp[i] = Tn[i];
+      lp0[i] = lp[i];
+      b0[i] = 0.0;
+    }
+    eexpv(m, &plcl[c0], &plcl[c0], acc);
+
+    int active = m;
+    for (int k = n-1; k >= 1 && active > 0; k--) {
+      double *Tk = &T[k*ncol+c0];
+      double *qk = &q[k*ncol+c0];
+      double *pk = &pf[k*ncol+c0];
+      elogv(m, pk, lp, lacc);
+// dry adiabat, also the first guess at the first level above the LCL
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        w[i] = lnth[i] + kappa*(lp[i] - lnp00);
+      }
+      eexpv(m, w, w, acc);
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        Tp[i] = (lp0[i] < lpl[i]) ? Tp[i] : w[i];
+      }
+      newton(m, acc, niter, pk, lp, lnthe, Tp, rs, es, lt);
+// buoyancy and areas of the layer up to pmin split at the zero crossing
+#pragma omp simd
+      for (int i = 0; i < m; i++) {
+        bool moist = lp[i] < lpl[i];
+        double rp = moist ? rs[i] : r[i];
+        Tp[i] = moist ? Tp[i] : w[i];
+        double b1 = Tp[i]*(1.0 + cv*rp/(1.0 + rp)) - Tk[i]*(1.0 + cv*qk[i]);
+        double lq = MAX(lp[i], lpmin);
+        b1 = b0[i] + (b1 - b0[i])*(lp0[i] - lq)/(lp0[i] - lp[i]);
+        double dl = lp0[i] - lq;
+        bool cross = (b0[i] > 0.0) != (b1 > 0.0);
+        double f = cross ? b0[i]/(b0[i] - b1) : 0.0;
+        double pos = 0.5*Rd*dl*(cross ? (b0[i] > 0.0 ? b0[i]*f : b1*(1.0 - f)) : (b1 > 0.0 ? b0[i] + b1 : 0.0));
+        double neg = 0.5*Rd*dl*(cross ? (b0[i] > 0.0 ? b1*(1.0 - f) : b0[i]*f) : (b1 > 0.0 ? 0.0 : b0[i] + b1));
+        int s = state[i];
+        if (s == 0) {
+          cin[c0+i] += neg;
+          if (b1 > 0.0 && lq <= lpl[i]) {
+            s = 1;
+            plfc[c0+i] = MIN(lp0[i] - f*dl, lpl[i]);
+            cape[c0+i] += pos;
+          }
+        } else if (s == 1) {
+          cape[c0+i] += pos;
+          s = (b1 > 0.0) ? 1 : 2;
+        }
+        state[i] = (lp[i] <= lpmin) ? 2 : s;
+        b0[i] = b1;
+        lp0[i] = lp[i];
+      }
+      active = 0;
+      for (int i = 0; i < m; i++) {
+        active += (state[i] != 2);
+      }
+    }
+    eexpv(m, &plfc[c0], &plfc[c0], acc);
+#pragma omp simd
+    for (int i = 0; i < m; i++) {
+      bool lfc = cape[c0+i] > 0.0;
+      plfc[c0+i] = lfc ? plfc[c0+i] : 0.0;
+      cin[c0+i] = lfc ? cin[c0+i] : 0.0;
+    }
+  }
+  return 0;
+}
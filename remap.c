@@ -0,0 +1,147 @@
+///  Interpolation weights between fixed grids
+/**
+ * @file remap.c
+ * @author Takeshi Enomoto
+ *
+ * # Algorithm
+ *
+ * The interpolated value at a target point is a linear combination of the
+ * source values on a small stencil.  The weights depend only on the grids, so
+ * they are located with eno_search_bisection() and computed once, stored as a
+ * sparse matrix with a fixed number of entries per target, and applied to any
+ * number of fields.
+ *
+ * Bicubic weights reproduce eno_bicubic_grid_interpolate(): with the Hermite basis
+ * \f[
+ * h_0 = 1-3t^2+2t^3,\; h_1 = 3t^2-2t^3,\; g_0 = t-2t^2+t^3,\; g_1 = -t^2+t^3
+ * \f]
+ * and centred differences for the derivatives, the 1-D weights on the nodes
+ * \f$i-1,\dots,i+2\f$ by eno_cubic_hermite_weights() are tensor products
+ * in \f$x\f$ and \f$y\f$ (16 entries).
+ *
+ * Biquadratic weights are the tensor product of quadratic Lagrange weights
+ * eno_biquadratic_weights() on the three nodes centred at the nearest node
+ * (9 entries) located by eno_biquadratic_locate(), which is
+ * eno_biquadratic_coeff() for a uniform grid.
+ *
+ * The field is stored with \f$x\f$ fastest: \f$f(i,j)\f$ = f[j*nx+i].
+ */
+#include <stdlib.h>
+#include <math.h>
+#include "remap.h"
+
+static eno_remap_t *alloc_remap(int nsrc, int n, int nnz)
+{
+  eno_remap_t *remap;
+  remap = (eno_remap_t *)malloc(sizeof(eno_remap_t));
+
+  remap->nsrc = nsrc;
+  remap->n = n;
+  remap->nnz = nnz;
+  remap->idx = (int *)malloc(sizeof(int) * n * nnz);
+  remap->w = (double *)malloc(sizeof(double) * n * nnz);
+  return remap;
+}
+
+eno_remap_t *eno_remap_init_bicubic /// compute bicubic weights from an nx x ny grid to n points
+  (
+    int nx,     ///< [in] # of source points in x
+    int ny,     ///< [in] # of source points in y
+    double *x,  ///< [in] x[nx] ascending or descending
+    double *y,  ///< [in] y[ny] ascending or descending
+    int n,      ///< [in] # of target points
+    double *xo, ///< [in] xo[n] target x
+    double *yo  ///< [in] yo[n] target y
+  )
+{
+  eno_remap_t *remap = alloc_remap(nx*ny, n, 16);
+
+#pragma omp parallel for
+  for (int k = 0; k < n; k++) {
+    int i = MAX(0, MIN(nx-2, eno_search_bisection(x, nx, xo[k])));
+    int j = MAX(0, MIN(ny-2, eno_search_bisection(y, ny, yo[k])));
+    double wx[4], wy[4];
+
+    eno_cubic_hermite_weights(x, nx, i, (xo[k] - x[i]) / (x[i+1] - x[i]), wx);
+    eno_cubic_hermite_weights(y, ny, j, (yo[k] - y[j]) / (y[j+1] - y[j]), wy);
+    for (int b = 0; b < 4; b++) {
+      int jb = MAX(0, MIN(ny-1, j+b-1));
+      for (int a = 0; a < 4; a++) {
+        int ia = MAX(0, MIN(nx-1, i+a-1));
+        remap->idx[16*k+4*b+a] = jb*nx + ia;
+        remap->w[16*k+4*b+a] = wx[a] * wy[b];
+      }
+    }
+  }
+  return remap;
+}
+
+eno_remap_t *eno_remap_init_biquadratic /// compute biquadratic weights from an nx x ny grid to n points
+  (
+    int nx,     ///< [in] # of source points in x, nx >= 3
+    int ny,     ///< [in] # of source points in y, ny >= 3
+    double *x,  ///< [in] x[nx] ascending or descending
+    double *y,  ///< [in] y[ny] ascending or descending
+    int n,      ///< [in] # of target points
+    double *xo, ///< [in] xo[n] target x
+    double *yo  ///< [in] yo[n] target y
+  )
+{
+  eno_remap_t *remap = alloc_remap(nx*ny, n, 9);
+
+#pragma omp parallel for
+  for (int k = 0; k < n; k++) {
+    int i = eno_biquadratic_locate(x, nx, xo[k]);
+    int j = eno_biquadratic_locate(y, ny, yo[k]);
+    double wx[3], wy[3];
+
+    eno_biquadratic_weights(x, i, xo[k], wx);
+    eno_biquadratic_weights(y, j, yo[k], wy);
+    for (int b = 0; b < 3; b++) {
+      for (int a = 0; a < 3; a++) {
+        remap->idx[9*k+3*b+a] = (j+b)*nx + i+a;
+        remap->w[9*k+3*b+a] = wx[a] * wy[b];
+      }
+    }
+  }
+  return remap;
+}
+
+int eno_remap_clean /// deallocate weights
+  (
+    eno_remap_t *remap ///< [inout] weights
+  )
+{
+  free(remap->idx);
+  free(remap->w);
+  free(remap);
+  return 0;
+}
+
+int eno_remap_apply /// interpolate nf fields with precomputed weights
+  (
+    eno_remap_t *remap, ///< [in]  weights
+    int nf,             ///< [in]  # of fields
+    double *f,          ///< [in]  f[nf*nsrc] source fields
+    double *fo          ///< [out] fo[nf*n] target fields
+  )
+{
+  int n = remap->n;
+  int nnz = remap->nnz;
+  int nsrc = remap->nsrc;
+
+#pragma omp parallel for
+  for (int k = 0; k < n; k++) {
+    int *idx = &remap->idx[nnz*k];
+    double *w = &remap->w[nnz*k];
+    for (int l = 0; l < nf; l++) {
+      double *fl = &f[l*nsrc];
+      double s = 0.0;
+      for (int m = 0; m < nnz; m++) {
+        s += w[m] * fl[idx[m]];
+      }
+      fo[l*n+k] = s;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,7 @@
+typedef struct eno_remap_t {
+  int nsrc;
+  int n;
+  int nnz;
+  int *idx;
+  double *w;
+}
@@ -4,7 +4,9 @@
  * @author: Takeshi Enomoto
  *
  */
+#include <stdlib.h>
 #include <stdbool.h>
+#include <math.h>
 #include "search.h"
 
 int eno_search_linear /// linear search
@@ -78,3 +80,312 @@ int eno_search_bisection /// bisection search
   }
   return il;
 }
+
+int eno_search_merge /// search m values at once, merge scan if they are sorted
+  (
+    double *y, /// < [in] asending or descending array
+    int n,     /// < [in] array length
+    int m,     /// < [in] # of values
+    double *x, /// < [in] x[m] values to match
+    int *idx   /// < [out] idx[m] same as eno_search_bisection()
+  )
+{
+// x[l] lies beyond y[i] in the direction of y, as in eno_search_bisection()
+  bool lascend = y[n-1] > y[0];
+  double s = lascend ? 1.0 : -1.0;
+  bool forward = true;
+  bool backward = true;
+
+  for (int l = 0; l < m-1; l++) {
+    forward = forward && s * (x[l+1] - x[l]) >= 0.0;
+    backward = backward && s * (x[l+1] - x[l]) <= 0.0;
+  }
+  if (forward) {
+// O(n+m) scan with increasing i
+    int i = -1;
+    for (int l = 0; l < m; l++) {
+      while (i < n-1 && EQV(x[l] > y[i+1], lascend)) {
+        i++;
+      }
+      idx[l] = i;
+    }
+  } else if (backward) {
+// O(n+m) scan with decreasing i
+    int i = n-1;
+    for (int l = 0; l < m; l++) {
+      while (i >= 0 && !EQV(x[l] > y[i], lascend)) {
+        i--;
+      }
+      idx[l] = i;
+    }
+  } else {
+    for (int l = 0; l < m; l++) {
+      idx[l] = eno_search_bisection(y, n, x[l]);
+    }
+  }
+  return 0;
+}
+
+/// hint to load the cache line at p
+static void prefetch(const void *p)
+{
+#ifdef __GNUC__
+  __builtin_prefetch(p);
+#endif
+}
+
+/// fill e[] in Eytzinger order from sorted z[] with an in-order walk, returns next j
+static int eytzinger(double *z, int *pos, double *e, int size, int j, int k)
+{
+  if (k < size) {
+    j = eytzinger(z, pos, e, size, j, 2*k);
+    e[k] = z[j];
+    pos[k] = j++;
+    j = eytzinger(z, pos, e, size, j, 2*k+1);
+  }
+  return j;
+}
+
+eno_search_tree_t *eno_search_tree_init /// build Eytzinger layout for repeated bisection
+  (
+    double *y, /// < [in] asending or descending array
+    int n      /// < [in] array length
+  )
+{
+  eno_search_tree_t *tree;
+  tree = (eno_search_tree_t *)malloc(sizeof(eno_search_tree_t));
+
+  tree->n = n;
+  tree->lascend = y[n-1] > y[0];
+  tree->h = 0;
+  while ((1 << tree->h) - 1 < n) {
+    tree->h++;
+  }
+  tree->size = 1 << tree->h;
+// sorted ascending and padded with infinity to a complete tree
+  double *z = (double *)malloc(sizeof(double) * tree->size);
+  for (int j = 0; j < tree->size - 1; j++) {
+    z[j] = (j < n) ? (tree->lascend ? y[j] : -y[j]) : INFINITY;
+  }
+  tree->e = (double *)malloc(sizeof(double) * tree->size);
+  tree->pos = (int *)malloc(sizeof(int) * tree->size);
+  tree->e[0] = -INFINITY;
+  tree->pos[0] = n;
+  eytzinger(z, tree->pos, tree->e, tree->size, 0, 1);
+  free(z);
+  return tree;
+}
+
+int eno_search_tree_clean /// deallocate search tree
+  (
+    eno_search_tree_t *tree /// < [inout] search tree
+  )
+{
+  free(tree->e);
+  free(tree->pos);
+  free(tree);
+  return 0;
+}
+
+/// index of bisection from the leaf k reached after h levels
+static int tree_index(eno_search_tree_t *tree, int k)
+{
+// drop the trailing right turns and the last left turn
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+  return (k == 0) ? tree->n - 1 : MIN(tree->pos[k], tree->n) - 1;
+}
+
+int eno_search_tree /// bisection search with Eytzinger layout
+  (
+    eno_search_tree_t *tree, /// < [in] search tree
+    double x                 /// < [in] value to match
+  )
+{
+  double *e = tree->e;
+  int last = tree->size - 1;
+  int k = 1;
+
+  if (tree->lascend) {
+    for (int l = 0; l < tree->h; l++) {
+      prefetch(&e[16*MIN(k, last/16)]);
+      k = 2*k + (e[k] < x);
+    }
+  } else {
+    for (int l = 0; l < tree->h; l++) {
+      prefetch(&e[16*MIN(k, last/16)]);
+      k = 2*k + (e[k] <= -x);
+    }
+  }
+  return tree_index(tree, k);
+}
+
+int eno_search_tree_batch /// bisection search of m values interleaved
+  (
+    eno_search_tree_t *tree, /// < [in]  search tree
+    int m,                   /// < [in]  # of values
+    double *x,               /// < [in]  x[m] values to match
+    int *idx                 /// < [out] idx[m] same as eno_search_bisection()
+  )
+{
+  double *e = tree->e;
+  int last = tree->size - 1;
+
+#pragma omp parallel for
+  for (int l0 = 0; l0 < m; l0 += TREE_BATCH) {
+    int nb = MIN(TREE_BATCH, m - l0);
+    int k[TREE_BATCH];
+    double q[TREE_BATCH];
+    for (int b = 0; b < nb; b++) {
+      k[b] = 1;
+      q[b] = tree->lascend ? x[l0+b] : -x[l0+b];
+    }
+// TREE_BATCH independent descents hide the latency of each other
+    for (int l = 0; l < tree->h; l++) {
+      if (tree->lascend) {
+        for (int b = 0; b < nb; b++) {
+          prefetch(&e[16*MIN(k[b], last/16)]);
+          k[b] = 2*k[b] + (e[k[b]] < q[b]);
+        }
+      } else {
+        for (int b = 0; b < nb; b++) {
+          prefetch(&e[16*MIN(k[b], last/16)]);
+          k[b] = 2*k[b] + (e[k[b]] <= q[b]);
+        }
+      }
+    }
+    for (int b = 0; b < nb; b++) {
+      idx[l0+b] = tree_index(tree, k[b]);
+    }
+  }
+  return 0;
+}
+
+eno_search_bucket_t *eno_search_bucket_init /// build bucket table for near-uniform arrays
+  (
+    double *y, /// < [in] asending or descending array
+    int n,     /// < [in] array length, n >= 2
+    int nb     /// < [in] # of buckets, n is a good choice
+  )
+{
+  eno_search_bucket_t *bucket;
+  bucket = (eno_search_bucket_t *)malloc(sizeof(eno_search_bucket_t));
+
+  bucket->n = n;
+  bucket->s = SIGN(y[n-1] - y[0]);
+  bucket->y = (double *)malloc(sizeof(double) * n);
+  for (int i = 0; i < n; i++) {
+    bucket->y[i] = y[i];
+  }
+// affine map from y to the bucket
+  bucket->y0 = y[0];
+  bucket->scale = nb / (y[n-1] - y[0]);
+  bucket->nb = nb;
+  bucket->start = (int *)malloc(sizeof(int) * (nb+1));
+  int i = 0;
+  for (int b = 0; b < nb+1; b++) {
+    double v = y[0] + (y[n-1] - y[0]) * b / nb;
+    i = MAX(0, eno_search_linear(y, n, v, i));
+    bucket->start[b] = i;
+  }
+  return bucket;
+}
+
+int eno_search_bucket_clean /// deallocate bucket table
+  (
+    eno_search_bucket_t *bucket /// < [inout] bucket table
+  )
+{
+  free(bucket->y);
+  free(bucket->start);
+  free(bucket);
+  return 0;
+}
+
+int eno_search_bucket /// search with bucket table, same as eno_search_linear()
+  (
+    eno_search_bucket_t *bucket, /// < [in] bucket table
+    double x                     /// < [in] value to match
+  )
+{
+  int n = bucket->n;
+  int s = bucket->s;
+  double *y = bucket->y;
+
+// out of range
+  if (s * (x - y[0]) < 0.0) {
+    return -1;
+  } else if (s * (x - y[n-1]) >= 0.0) {
+    return n - 1;
+  }
+// first guess from the bucket, then correct locally
+  int b = MIN(bucket->nb, (int)((x - bucket->y0) * bucket->scale));
+  int i = bucket->start[b];
+  while (i > 0 && s * (x - y[i]) < 0.0) {
+    i--;
+  }
+  while (s * (x - y[i+1]) >= 0.0) {
+    i++;
+  }
+  return i;
+}
+
+int eno_search_bucket_batch /// search m values with bucket table
+  (
+    eno_search_bucket_t *bucket, /// < [in]  bucket table
+    int m,                       /// < [in]  # of values
+    double *x,                   /// < [in]  x[m] values to match
+    int *idx                     /// < [out] idx[m] same as eno_search_linear()
+  )
+{
+#pragma omp parallel for
+  for (int l = 0; l < m; l++) {
+    idx[l] = eno_search_bucket(bucket, x[l]);
+  }
+  return 0;
+}
+
+int eno_search_column /// bisection search of one value in each of ncol columns in lockstep
+  (
+    double *y, /// < [in]  y[n*ncol] asending or descending in each column, y[k*ncol+c]
+    int n,     /// < [in]  # of levels
+    int ncol,  /// < [in]  # of columns
+    double *x, /// < [in]  x[ncol] value to match in each column
+    int *idx   /// < [out] idx[ncol] same as eno_search_bisection() in each column
+  )
+{
+  int h = 0;
+
+  while ((1 << h) < n+1) {
+    h++;
+  }
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    int il[COLUMN_BLOCK], iu[COLUMN_BLOCK];
+    bool lascend[COLUMN_BLOCK];
+    for (int c = c0; c < c1; c++) {
+      il[c-c0] = -1;
+      iu[c-c0] = n;
+      lascend[c-c0] = y[(n-1)*ncol+c] > y[c];
+    }
+// the same number of steps in all columns, finished columns are masked
+    for (int l = 0; l < h; l++) {
+#pragma omp simd
+      for (int c = c0; c < c1; c++) {
+        int b = c - c0;
+        int im = MAX(0, (il[b] + iu[b]) / 2);
+        bool active = iu[b] - il[b] > 1;
+        bool beyond = EQV(x[c] > y[im*ncol+c], lascend[b]);
+        il[b] = (active && beyond) ? im : il[b];
+        iu[b] = (active && !beyond) ? im : iu[b];
+      }
+    }
+    for (int c = c0; c < c1; c++) {
+      idx[c] = il[c-c0];
+    }
+  }
+  return 0;
+}
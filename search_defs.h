@@ -0,0 +1 @@
+#define TREE_BATCH 8
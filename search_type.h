@@ -0,0 +1,18 @@
+typedef struct eno_search_tree_t {
+  int n;
+  int h;
+  int size;
+  bool lascend;
+  double *e;
+  int *pos;
+}
+
+typedef struct eno_search_bucket_t {
+  int n;
+  int s;
+  double *y;
+  double y0;
+  double scale;
+  int nb;
+  int *start;
+}
@@ -0,0 +1,226 @@
+/// Semi-Lagrangian departure points on the sphere
+/**
+ * @file semilag.c
+ * @author Takeshi Enomoto
+ *
+ * # Algorithm
+ *
+ * The departure point \f$\mathbf{r}_d\f$ of the air arriving at each grid point
+ * \f$\mathbf{r}_a\f$ is found by the midpoint rule on the sphere (Ritchie 1987)
+ * \f[
+ * \mathbf{r}_m = \frac{\mathbf{r}_a - \frac{\Delta t}{2a}\mathbf{V}_m}
+ *                     {|\mathbf{r}_a - \frac{\Delta t}{2a}\mathbf{V}_m|},\quad
+ * \mathbf{r}_d = 2(\mathbf{r}_a\cdot\mathbf{r}_m)\mathbf{r}_m - \mathbf{r}_a
+ * \f]
+ * iterated with the wind \f$\mathbf{V}_m\f$ interpolated at the midpoint.
+ * The first guess of \f$\mathbf{V}_m\f$ is the wind at the arrival point.
+ *
+ * Winds are interpolated by the quasi-cubic Lagrange interpolation:
+ * cubic in longitude on the two inner latitudes of the 4x4 stencil,
+ * linear on the outer two and cubic in latitude (12 points).
+ * Longitude is periodic and the rows beyond the last latitudes are read
+ * across the pole with the sign of the wind components reversed,
+ * mapped to the grid as in eno_bicubic_grid_init_sphere().
+ *
+ * The cells of the midpoints are kept between iterations and calls
+ * and used as starting values of eno_search_linear(),
+ * so that locating them costs a few comparisons.
+ *
+ * Levels are treated independently; winds are stored as
+ * u[(k*nlat+j)*nlon+i] for longitude i, latitude j and level k.
+ *
+ * # Reference
+ *
+ * - Ritchie, H., 1987: Semi-Lagrangian advection on a Gaussian grid. MWR, 115, 608--619.
+ * - Ritchie, H. et al., 1995: Implementation of the semi-Lagrangian method in a
+ *   high-resolution version of the ECMWF forecast model. MWR, 123, 489--514.
+ */
+#include <stdlib.h>
+#include <math.h>
+#include "semilag.h"
+
+/// wind component at node (i,j) of a level, reversed across the poles
+static double wind_node(eno_semilag_t *sl, double *w, int i, int j)
+{
+  double s = eno_bicubic_grid_sphere_node(sl->nlon, sl->nlat, &i, &j);
+
+  return s * w[j*sl->nlon+i];
+}
+
+/// quasi-cubic interpolation of (u,v) at (x,y) starting the search from (*i,*j)
+static void interpolate_wind
+  (
+    eno_semilag_t *sl, ///< [in]    departure point engine
+    double *u,         ///< [in]    zonal wind of the level
+    double *v,         ///< [in]    meridional wind of the level
+    double x,          ///< [in]    longitude
+    double y,          ///< [in]    latitude
+    int *i,            ///< [inout] longitude cell
+    int *j,            ///< [inout] latitude cell
+    double *ui,        ///< [out]   interpolated u
+    double *vi         ///< [out]   interpolated v
+  )
+{
+  double xa[4], ya[4], wx[4], wy[4];
+
+  x = sl->lon[0] + FMOD(x - sl->lon[0], 2.0 * M_PI);
+  *i = MAX(0, eno_search_linear(sl->lon, sl->nlon, x, *i));
+  *j = eno_search_linear(sl->lat, sl->nlat, y, *j);
+  for (int l = 0; l < 4; l++) {
+    xa[l] = eno_bicubic_grid_sphere_x(sl->nlon, sl->lon, 2.0 * M_PI, *i-1+l);
+    ya[l] = eno_bicubic_grid_sphere_y(sl->nlat, sl->lat, sl->pole, *j-1+l);
+  }
+  eno_cubic_lagrange_weights(xa, x, wx);
+  eno_cubic_lagrange_weights(ya, y, wy);
+  double t = (x - xa[1]) / (xa[2] - xa[1]);
+
+  *ui = 0.0;
+  *vi = 0.0;
+  for (int b = 0; b < 4; b++) {
+    int jb = *j-1+b;
+    double ur = 0.0, vr = 0.0;
+    if (b == 0 || b == 3) {
+      ur = (1.0-t)*wind_node(sl, u, *i, jb) + t*wind_node(sl, u, *i+1, jb);
+      vr = (1.0-t)*wind_node(sl, v, *i, jb) + t*wind_node(sl, v, *i+1, jb);
+    } else {
+      for (int a = 0; a < 4; a++) {
+        ur += wx[a]*wind_node(sl, u, *i-1+a, jb);
+        vr += wx[a]*wind_node(sl, v, *i-1+a, jb);
+      }
+    }
+    *ui += wy[b]*ur;
+    *vi += wy[b]*vr;
+  }
+}
+
+/// position vector of (lon, lat)
+static void cartesian(double lon, double lat, double r[3])
+{
+  r[0] = cos(lat)*cos(lon);
+  r[1] = cos(lat)*sin(lon);
+  r[2] = sin(lat);
+}
+
+/// velocity vector of wind (u, v) at (lon, lat)
+static void velocity(double lon, double lat, double u, double v, double w[3])
+{
+  w[0] = -u*sin(lon) - v*sin(lat)*cos(lon);
+  w[1] =  u*cos(lon) - v*sin(lat)*sin(lon);
+  w[2] =  v*cos(lat);
+}
+
+/// normalized r - c w and its longitude and latitude
+static void midpoint(double r[3], double c, double w[3], double m[3], double *lon, double *lat)
+{
+  double s = 0.0;
+
+  for (int l = 0; l < 3; l++) {
+    m[l] = r[l] - c*w[l];
+    s += m[l]*m[l];
+  }
+  s = 1.0/sqrt(s);
+  for (int l = 0; l < 3; l++) {
+    m[l] *= s;
+  }
+  *lon = atan2(m[1], m[0]);
+  *lat = asin(MAX(-1.0, MIN(1.0, m[2])));
+}
+
+eno_semilag_t *eno_semilag_init /// allocate departure point engine for a global grid
+  (
+    int nlon,    ///< [in] # of longitudes, even
+    int nlat,    ///< [in] # of latitudes
+    int nlev,    ///< [in] # of levels
+    double *lon, ///< [in] lon[nlon] ascending in radians, lon[0]+2pi excluded
+    double *lat, ///< [in] lat[nlat] ascending or descending in radians, poles excluded
+    int niter    ///< [in] # of iterations for the midpoint
+  )
+{
+  eno_semilag_t *sl;
+  sl = (eno_semilag_t *)malloc(sizeof(eno_semilag_t));
+
+  sl->nlon = nlon;
+  sl->nlat = nlat;
+  sl->nlev = nlev;
+  sl->niter = niter;
+  sl->lon = (double *)malloc(sizeof(double) * nlon);
+  sl->lat = (double *)malloc(sizeof(double) * nlat);
+  for (int i = 0; i < nlon; i++) {
+    sl->lon[i] = lon[i];
+  }
+  for (int j = 0; j < nlat; j++) {
+    sl->lat[j] = lat[j];
+  }
+  sl->pole[0] = (lat[0] > lat[nlat-1]) ? 0.5*M_PI : -0.5*M_PI;
+  sl->pole[1] = -sl->pole[0];
+  int n = nlev * nlat * nlon;
+  sl->icell = (int *)malloc(sizeof(int) * n);
+  sl->jcell = (int *)malloc(sizeof(int) * n);
+  for (int k = 0; k < nlev; k++) {
+    for (int j = 0; j < nlat; j++) {
+      for (int i = 0; i < nlon; i++) {
+        sl->icell[(k*nlat+j)*nlon+i] = i;
+        sl->jcell[(k*nlat+j)*nlon+i] = j;
+      }
+    }
+  }
+  return sl;
+}
+
+int eno_semilag_clean /// deallocate departure point engine
+  (
+    eno_semilag_t *sl ///< [inout] departure point engine
+  )
+{
+  free(sl->lon);
+  free(sl->lat);
+  free(sl->icell);
+  free(sl->jcell);
+  free(sl);
+  return 0;
+}
+
+int eno_semilag_departure /// calculate departure points of all grid points and levels
+  (
+    eno_semilag_t *sl, ///< [inout] departure point engine, cells of the midpoints are updated
+    double dt,         ///< [in]    time step, s
+    double *u,         ///< [in]    u[nlev*nlat*nlon] zonal wind at the middle of the step, m/s
+    double *v,         ///< [in]    v[nlev*nlat*nlon] meridional wind at the middle of the step, m/s
+    double *lond,      ///< [out]   lond[nlev*nlat*nlon] departure longitude in [-pi, pi]
+    double *latd       ///< [out]   latd[nlev*nlat*nlon] departure latitude
+  )
+{
+  int nlon = sl->nlon;
+  int nlat = sl->nlat;
+  int nlev = sl->nlev;
+  double c = 0.5 * dt / eno_earth_radius;
+
+#pragma omp parallel for collapse(2)
+  for (int k = 0; k < nlev; k++) {
+    for (int j = 0; j < nlat; j++) {
+      double *uk = &u[k*nlat*nlon];
+      double *vk = &v[k*nlat*nlon];
+      for (int i = 0; i < nlon; i++) {
+        int l = (k*nlat+j)*nlon+i;
+        double ra[3], rm[3], w[3];
+        double lonm, latm, um, vm;
+
+        cartesian(sl->lon[i], sl->lat[j], ra);
+        velocity(sl->lon[i], sl->lat[j], uk[j*nlon+i], vk[j*nlon+i], w);
+        for (int it = 0; it < sl->niter; it++) {
+          midpoint(ra, c, w, rm, &lonm, &latm);
+          interpolate_wind(sl, uk, vk, lonm, latm, &sl->icell[l], &sl->jcell[l], &um, &vm);
+          velocity(lonm, latm, um, vm, w);
+        }
+        midpoint(ra, c, w, rm, &lonm, &latm);
+        double d = 2.0 * (ra[0]*rm[0] + ra[1]*rm[1] + ra[2]*rm[2]);
+        for (int m = 0; m < 3; m++) {
+          rm[m] = d*rm[m] - ra[m];
+        }
+        lond[l] = atan2(rm[1], rm[0]);
+        latd[l] = asin(MAX(-1.0, MIN(1.0, rm[2])));
+      }
+    }
+  }
+  return 0;
+}
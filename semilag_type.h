@@ -0,0 +1,7 @@
+typedef struct eno_semilag_t {
+  int nlon, nlat, nlev;
+  double *lon, *lat;
+  double pole[2];
+  int niter;
+  int *icell, *jcell;
+}
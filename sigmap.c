@@ -3,12 +3,40 @@
  * @file: sigmap.c
  * @author: Takeshi Enomoto 
  *
+ * eno_sigmap_init_borrow() sets up a structure owned by the caller that refers to
+ * a and b without copying, and eno_sigmap_calc_column() works in a workspace
+ * of eno_sigmap_work_size() doubles given by the caller,
+ * so that one structure is shared by threads without allocation.
+ *
+ * Functions with the suffix _grid work on many columns stored level-major,
+ * x[k*ncol+c], with the level indices of the single-column functions.
+ *
+ * eno_sigmap_calc_pgf_grid() and eno_sigmap_calc_omega_grid() are the vertical
+ * discretization of Simmons and Burridge (1981) with
+ * \f$\nabla p_{k+1/2} = B_{k+1/2}\nabla p_s\f$ and
+ * \f$\nabla\cdot(\mathbf{v}_k\Delta p_k) = D_k\Delta p_k + \Delta B_k\mathbf{v}_k\cdot\nabla p_s\f$:
+ * \f[
+ * (R_dT_v\nabla\ln p)_k = \frac{R_dT_{v,k}}{\Delta p_k}\left[\beta_k\nabla p_{k-1/2}+\alpha_k\nabla\Delta p_k\right],
+ * \f]
+ * \f[
+ * \frac{\partial p_s}{\partial t} = -\sum_{j=1}^{n}\nabla\cdot(\mathbf{v}_j\Delta p_j),\quad
+ * \left(\dot\eta\frac{\partial p}{\partial\eta}\right)_{k+1/2} = -B_{k+1/2}\frac{\partial p_s}{\partial t}
+ *   - \sum_{j=1}^{k}\nabla\cdot(\mathbf{v}_j\Delta p_j),
+ * \f]
+ * \f[
+ * \left(\frac{\omega}{p}\right)_k = -\frac{1}{\Delta p_k}\left[\beta_k\sum_{j=1}^{k-1}\nabla\cdot(\mathbf{v}_j\Delta p_j)
+ *   + \alpha_k\nabla\cdot(\mathbf{v}_k\Delta p_k)\right]
+ *   + \frac{\mathbf{v}_k}{\Delta p_k}\cdot\left[\beta_k\nabla p_{k-1/2}+\alpha_k\nabla\Delta p_k\right],
+ * \f]
+ * where \f$\beta_1\f$ terms vanish.
+ *
  * # Refences
  * - Eckermann (2009) MWR
  * - Ritchie et al. (1994) MWR
  * - Simmons and Burridge (1981) MWR
  */
 #include <stdlib.h>
+#include <stdbool.h>
 #include <math.h>
 #include "sigmap.h"
 
@@ -35,18 +63,52 @@ eno_sigmap_t *eno_sigmap_init /// allocate structure and associated arrays
     sigmap->db[i] = b[i] - b[i-1];
   }
   sigmap->ptop = ptop;
+  sigmap->own = true;
+  return sigmap;
+}
+
+eno_sigmap_t *eno_sigmap_init_borrow /// set up caller's structure without allocation
+  (
+    eno_sigmap_t *sigmap, /// < [out] sigmap structure provided by the caller
+    int n,                /// < [in] # of layers
+    double *a,            /// < [in] hybrid A: p, referenced, not copied
+    double *b,            /// < [in] hybrid B: sigma, referenced, not copied
+    double *db,           /// < [out] db[n+1] storage for the differences of b
+    double ptop           /// < [in] model top pressure (Pa)
+  )
+{
+  sigmap->n = n;
+  sigmap->a = a;
+  sigmap->b = b;
+  sigmap->db = db;
+  db[0] = 0.0;
+  for (int i = 1; i < n+1; i++) {
+    db[i] = b[i] - b[i-1];
+  }
+  sigmap->ptop = ptop;
+  sigmap->own = false;
   return sigmap;
 }
 
+int eno_sigmap_work_size /// # of doubles of the workspace of eno_sigmap_calc_column()
+  (
+    eno_sigmap_t *sigmap /// < [in] sigmap structure
+  )
+{
+  return 6 * (sigmap->n + 1);
+}
+
 int eno_sigmap_clean /// deallocate structure and associated arrays
   (
     eno_sigmap_t *sigmap /// < [inout] hybrid sigma-p structure
   )
 {
-  free(sigmap->a);
-  free(sigmap->b);
-  free(sigmap->db);
-  free(sigmap);
+  if (sigmap->own) {
+    free(sigmap->a);
+    free(sigmap->b);
+    free(sigmap->db);
+    free(sigmap);
+  }
   return 0;
 }
 
@@ -110,4 +172,294 @@ int eno_sigmap_calc_gz /// calculate geopotential
   }
   return 0;
 }
-  
+
+int eno_sigmap_calc_p_grid /// calculate half-pressure, layer thickness and full-level pressure of ncol columns, -1 for an unknown layout
+  (
+    eno_sigmap_t *sigmap, /// < [in] sigmap structure
+    int ncol,             /// < [in] # of columns
+    double *ps,           /// < [in] ps[ncol] surface pressure
+    int layout,           /// < [in] SIGMAP_LEVEL_MAJOR: [k*ncol+c], SIGMAP_COLUMN_MAJOR: [c*(n+1)+k]
+    double *ph,           /// < [out] ph[(n+1)*ncol] half-level pressure
+    double *dp,           /// < [out] dp[(n+1)*ncol] layer thickness, k = 1..n, skipped if NULL
+    double *pf            /// < [out] pf[(n+1)*ncol] full-level pressure, k = 1..n, skipped if NULL
+  )
+{
+  int n = sigmap->n;
+  double ptop = sigmap->ptop;
+  double *a = sigmap->a;
+  double *b = sigmap->b;
+  double *db = sigmap->db;
+
+  if (layout != SIGMAP_LEVEL_MAJOR && layout != SIGMAP_COLUMN_MAJOR) {
+    return -1;
+  }
+  if (layout == SIGMAP_LEVEL_MAJOR) {
+#pragma omp parallel for
+    for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+      int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+      for (int k = 0; k < n+1; k++) {
+        double *phk = &ph[k*ncol];
+#pragma omp simd
+        for (int c = c0; c < c1; c++) {
+          phk[c] = a[k] + b[k]*(ps[c] - ptop);
+        }
+        if (k == 0) {
+          continue;
+        }
+        double da = a[k] - a[k-1];
+        if (dp != NULL) {
+          double *dpk = &dp[k*ncol];
+#pragma omp simd
+          for (int c = c0; c < c1; c++) {
+            dpk[c] = da + db[k]*(ps[c] - ptop);
+          }
+        }
+        if (pf != NULL) {
+          double *pfk = &pf[k*ncol];
+#pragma omp simd
+          for (int c = c0; c < c1; c++) {
+            pfk[c] = 0.5*(phk[c-ncol] + phk[c]);
+          }
+        }
+      }
+    }
+  } else if (layout == SIGMAP_COLUMN_MAJOR) {
+#pragma omp parallel for
+    for (int c = 0; c < ncol; c++) {
+      double *phc = &ph[c*(n+1)];
+      double psc = ps[c] - ptop;
+      for (int k = 0; k < n+1; k++) {
+        phc[k] = a[k] + b[k]*psc;
+      }
+      for (int k = 1; k < n+1; k++) {
+        if (dp != NULL) {
+          dp[c*(n+1)+k] = (a[k] - a[k-1]) + db[k]*psc;
+        }
+        if (pf != NULL) {
+          pf[c*(n+1)+k] = 0.5*(phc[k-1] + phc[k]);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+int eno_sigmap_calc_gz_grid /// calculate geopotential of ncol columns from ps, T and q in one pass
+  (
+    eno_sigmap_t *sigmap, /// < [in] sigmap structure
+    int ncol,             /// < [in] # of columns
+    double *ps,           /// < [in] ps[ncol] surface pressure
+    double *gzs,          /// < [in] gzs[ncol] surface geopotential
+    double *T,            /// < [in] T[(n+1)*ncol] temperature, T[k*ncol+c] for k = 1..n
+    double *q,            /// < [in] q[(n+1)*ncol] specific humidity, dry if NULL
+    double *gz            /// < [out] gz[(n+1)*ncol] full-level geopotential
+  )
+{
+  const double Rd = eno_air_Rd;
+  int n = sigmap->n;
+  double ptop = sigmap->ptop;
+  double *a = sigmap->a;
+  double *b = sigmap->b;
+  double *db = sigmap->db;
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    double gzh[COLUMN_BLOCK], phl[COLUMN_BLOCK];
+    for (int c = c0; c < c1; c++) {
+      gzh[c-c0] = gzs[c];
+      phl[c-c0] = a[n] + b[n]*(ps[c] - ptop);
+    }
+// from the surface upward, only the lower half level is kept
+    for (int k = n; k > 0; k--) {
+      double da = a[k] - a[k-1];
+#pragma omp simd
+      for (int c = c0; c < c1; c++) {
+        int j = c - c0;
+        double psc = ps[c] - ptop;
+        double Tv = (q != NULL) ? eno_moist_calc_Tv(T[k*ncol+c], q[k*ncol+c]) : T[k*ncol+c];
+        double phu = a[k-1] + b[k-1]*psc;
+        double alpha, beta;
+        if (k > 1) {
+          double dp = da + db[k]*psc;
+          beta = log(phl[j]/phu);
+          alpha = 1.0 - phu/dp*beta;
+        } else {
+          beta = 0.0;
+          alpha = log(2.0);
+        }
+        gz[k*ncol+c] = gzh[j] + alpha*Rd*Tv;
+        gzh[j] += beta*Rd*Tv;
+        phl[j] = phu;
+      }
+    }
+  }
+  return 0;
+}
+
+int eno_sigmap_calc_column /// calculate pressure and geopotential of a column in caller's workspace
+  (
+    eno_sigmap_t *sigmap, /// < [in] sigmap structure
+    double ps,            /// < [in] surface pressure
+    double gzs,           /// < [in] surface geopotential
+    double *T,            /// < [in] T[n+1] temperature
+    double *q,            /// < [in] q[n+1] specific humidity, dry if NULL
+    double *work,         /** < [out] work[eno_sigmap_work_size()] ph, dp, pf, alpha, beta
+                            *  and Tv of n+1 elements each in this order */
+    double *gz            /// < [out] gz[n+1] full-level geopotential
+  )
+{
+  int n = sigmap->n;
+  double *ph = work;
+  double *dp = &work[n+1];
+  double *pf = &work[2*(n+1)];
+  double *alpha = &work[3*(n+1)];
+  double *beta = &work[4*(n+1)];
+  double *Tv = &work[5*(n+1)];
+
+  for (int k = 1; k < n+1; k++) {
+    Tv[k] = (q != NULL) ? eno_moist_calc_Tv(T[k], q[k]) : T[k];
+  }
+  eno_sigmap_calc_p(sigmap, ps, ph, dp, pf);
+  beta[1] = 0.0;
+  eno_sigmap_calc_alphabeta(sigmap, ph, dp, alpha, beta);
+  eno_sigmap_calc_gz(sigmap, gzs, alpha, beta, Tv, gz);
+  return 0;
+}
+
+int eno_sigmap_calc_alphabeta_grid /// calculate alpha and beta of ncol columns with vectorized log
+  (
+    eno_sigmap_t *sigmap, /// < [in] sigmap structure
+    int ncol,             /// < [in] # of columns
+    double *ph,           /// < [in] ph[(n+1)*ncol] half-level pressure, level-major
+    double *dp,           /// < [in] dp[(n+1)*ncol] layer thickness, level-major
+    int acc,              /// < [in] accuracy of log, ELOG_FULL or ELOG_FAST
+    double *alpha,        /// < [out] alpha[(n+1)*ncol], k = 1..n
+    double *beta          /// < [out] beta[(n+1)*ncol], k = 2..n
+  )
+{
+  int n = sigmap->n;
+  double ln2 = log(2.0);
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int nb = MIN(COLUMN_BLOCK, ncol - c0);
+    for (int c = c0; c < c0+nb; c++) {
+      alpha[ncol+c] = ln2;
+    }
+    for (int k = 2; k < n+1; k++) {
+      double *phk = &ph[k*ncol], *phu = &ph[(k-1)*ncol];
+      double *betak = &beta[k*ncol], *alphak = &alpha[k*ncol], *dpk = &dp[k*ncol];
+#pragma omp simd
+      for (int c = c0; c < c0+nb; c++) {
+        betak[c] = phk[c]/phu[c];
+      }
+      elogv(nb, &betak[c0], &betak[c0], acc);
+#pragma omp simd
+      for (int c = c0; c < c0+nb; c++) {
+        alphak[c] = 1.0 - phu[c]/dpk[c]*betak[c];
+      }
+    }
+  }
+  return 0;
+}
+
+int eno_sigmap_calc_pgf_grid /// calculate pressure-gradient terms of ncol columns
+  (
+    eno_sigmap_t *sigmap, /// < [in] sigmap structure
+    int ncol,             /// < [in] # of columns
+    double *dp,           /// < [in] dp[(n+1)*ncol] layer thickness
+    double *alpha,        /// < [in] alpha[(n+1)*ncol]
+    double *beta,         /// < [in] beta[(n+1)*ncol]
+    double *Tv,           /// < [in] Tv[(n+1)*ncol] virtual temperature
+    double *dpsdx,        /// < [in] dpsdx[ncol] x-derivative of surface pressure
+    double *dpsdy,        /// < [in] dpsdy[ncol] y-derivative of surface pressure
+    double *px,           /// < [out] px[(n+1)*ncol] x-component of RTv grad ln p
+    double *py            /// < [out] py[(n+1)*ncol] y-component of RTv grad ln p
+  )
+{
+  const double Rd = eno_air_Rd;
+  int n = sigmap->n;
+  double *b = sigmap->b;
+  double *db = sigmap->db;
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    for (int k = 1; k < n+1; k++) {
+      double bu = (k > 1) ? b[k-1] : 0.0;
+#pragma omp simd
+      for (int c = c0; c < c1; c++) {
+        int i = k*ncol+c;
+        double betak = (k > 1) ? beta[i] : 0.0;
+        double r = Rd*Tv[i]/dp[i]*(betak*bu + alpha[i]*db[k]);
+        px[i] = r*dpsdx[c];
+        py[i] = r*dpsdy[c];
+      }
+    }
+  }
+  return 0;
+}
+
+int eno_sigmap_calc_omega_grid /// calculate surface pressure tendency, vertical velocities of ncol columns
+  (
+    eno_sigmap_t *sigmap, /// < [in] sigmap structure
+    int ncol,             /// < [in] # of columns
+    double *dp,           /// < [in] dp[(n+1)*ncol] layer thickness
+    double *pf,           /// < [in] pf[(n+1)*ncol] full-level pressure
+    double *alpha,        /// < [in] alpha[(n+1)*ncol]
+    double *beta,         /// < [in] beta[(n+1)*ncol]
+    double *u,            /// < [in] u[(n+1)*ncol] x-component of wind
+    double *v,            /// < [in] v[(n+1)*ncol] y-component of wind
+    double *d,            /// < [in] d[(n+1)*ncol] divergence
+    double *dpsdx,        /// < [in] dpsdx[ncol] x-derivative of surface pressure
+    double *dpsdy,        /// < [in] dpsdy[ncol] y-derivative of surface pressure
+    double *dpsdt,        /// < [out] dpsdt[ncol] surface pressure tendency
+    double *etadot,       /// < [out] etadot[(n+1)*ncol] \f$\dot\eta\partial p/\partial\eta\f$ at half levels k = 0..n, skipped if NULL
+    double *omega         /// < [out] omega[(n+1)*ncol] full-level \f$\omega\f$, skipped if NULL
+  )
+{
+  int n = sigmap->n;
+  double *b = sigmap->b;
+  double *db = sigmap->db;
+
+#pragma omp parallel for
+  for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+    int c1 = MIN(ncol, c0 + COLUMN_BLOCK);
+    double sum[COLUMN_BLOCK];
+    for (int c = c0; c < c1; c++) {
+      sum[c-c0] = 0.0;
+    }
+// omega from the top, accumulating the divergence of mass flux
+    for (int k = 1; k < n+1; k++) {
+      double bu = (k > 1) ? b[k-1] : 0.0;
+#pragma omp simd
+      for (int c = c0; c < c1; c++) {
+        int i = k*ncol+c;
+        double vgp = u[i]*dpsdx[c] + v[i]*dpsdy[c];
+        double div = d[i]*dp[i] + db[k]*vgp;
+        if (omega != NULL) {
+          double betak = (k > 1) ? beta[i] : 0.0;
+          omega[i] = pf[i]/dp[i]*(-betak*sum[c-c0] - alpha[i]*div
+            + (betak*bu + alpha[i]*db[k])*vgp);
+        }
+        sum[c-c0] += div;
+        if (etadot != NULL) {
+          etadot[i] = -sum[c-c0];
+        }
+      }
+    }
+    for (int c = c0; c < c1; c++) {
+      dpsdt[c] = -sum[c-c0];
+    }
+    if (etadot != NULL) {
+      for (int k = 0; k < n+1; k++) {
+#pragma omp simd
+        for (int c = c0; c < c1; c++) {
+          etadot[k*ncol+c] = (k > 0 ? etadot[k*ncol+c] : 0.0) - b[k]*dpsdt[c];
+        }
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,2 @@
+#define SIGMAP_LEVEL_MAJOR  0
+#define SIGMAP_COLUMN_MAJOR 1
@@ -4,4 +4,5 @@ typedef struct eno_sigmap_t {
   double* b;
   double* db;
   double ptop;
+  bool own;
 }
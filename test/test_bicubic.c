@@ -1,6 +1,7 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
 //#include <CUnit/Console.h>
+#include <stdbool.h>
 #include "bicubic.h"
 
 void test_bicubic(double f[16], double d[16], double g[5], double gx[5], double gy[5], double gxy[5])
@@ -35,10 +36,28 @@ void test_bicubic(double f[16], double d[16], double g[5], double gx[5], double
     CU_ASSERT_EQUAL(px,  gx[i]);
     CU_ASSERT_EQUAL(py,  gy[i]);
     CU_ASSERT_EQUAL(pxy, gxy[i]);
+    eno_bicubic_interpolate_fused(c, t[i], u[i], &p, &px, &py, &pxy);
+    CU_ASSERT_EQUAL(p,   g[i]);
+    CU_ASSERT_EQUAL(px,  gx[i]);
+    CU_ASSERT_EQUAL(py,  gy[i]);
+    CU_ASSERT_EQUAL(pxy, gxy[i]);
 #ifdef VERBOSE
     printf("t=%f, u=%f, p=%f, px=%f, py=%f, pxy=%f\n", t[i], u[i], p, px, py, pxy);
 #endif
   }
+
+  double cb[16*5], pb[5], pxb[5], pyb[5];
+  for (int l=0; l<16; l++) {
+    for (int i=0; i<5; i++) {
+      cb[l*5+i] = c[l];
+    }
+  }
+  eno_bicubic_interpolate_batch(5, cb, t, u, false, pb, pxb, pyb, NULL);
+  for (int i=0; i<5; i++) {
+    CU_ASSERT_EQUAL(pb[i],  g[i]);
+    CU_ASSERT_EQUAL(pxb[i], gx[i]);
+    CU_ASSERT_EQUAL(pyb[i], gy[i]);
+  }
 }
 
 void test_bicubic_constant(void)
@@ -111,6 +130,86 @@ void test_bicubic_cossin(void)
   test_bicubic(f, d, g, gx, gy, gxy);
 }
 
+/// compare the batched coefficients with the dense 16x16 matrix
+void test_bicubic_batch(void)
+{
+  const int n = 3;
+  double a[16*16] = {
+ 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+-3, 0, 0, 3, 0, 0, 0, 0,-2, 0, 0,-1, 0, 0, 0, 0,
+ 2, 0, 0,-2, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0,
+ 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+ 0, 0, 0, 0,-3, 0, 0, 3, 0, 0, 0, 0,-2, 0, 0,-1,
+ 0, 0, 0, 0, 2, 0, 0,-2, 0, 0, 0, 0, 1, 0, 0, 1,
+-3, 3, 0, 0,-2,-1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+ 0, 0, 0, 0, 0, 0, 0, 0,-3, 3, 0, 0,-2,-1, 0, 0,
+ 9,-9, 9,-9, 6, 3,-3,-6, 6,-6,-3, 3, 4, 2, 1, 2,
+-6, 6,-6, 6,-4,-2, 2, 4,-3, 3, 3,-3,-2,-1,-1,-2,
+ 2,-2, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+ 0, 0, 0, 0, 0, 0, 0, 0, 2,-2, 0, 0, 1, 1, 0, 0,
+-6, 6,-6, 6,-3,-3, 3, 3,-4, 4, 2,-2,-2,-2,-1,-1,
+ 4,-4, 4,-4, 2, 2,-2,-2, 2,-2,-2, 2, 1, 1, 1, 1
+  };
+  double f[16*n], c[16*n];
+
+  for (int l = 0; l < 16; l++) {
+    for (int k = 0; k < n; k++) {
+      f[l*n+k] = (l + 1) * (k - 1) + 0.5 * l * l;
+    }
+  }
+  eno_bicubic_coeff_batch(n, f, c);
+  for (int k = 0; k < n; k++) {
+    for (int i = 0; i < 16; i++) {
+      double d = 0.0;
+      for (int j = 0; j < 16; j++) {
+        d += a[16*i+j] * f[j*n+k];
+      }
+      CU_ASSERT_EQUAL(c[i*n+k], d);
+    }
+  }
+}
+
+/// limited values stay within the corners and agree between the batch and multi kernels
+void test_bicubic_mono(void)
+{
+  const int m = 25;
+  const int nv = 2;
+  double f[16] = {0, 1, 1, 0, 4, 4, -4, -4, 0, 3, 0, -3, 0, 0, 0, 0};
+  double fv[16*nv], c[16], cb[16*m], cv[16*nv];
+  double t[m], u[m], p[m], pm[m], pv[nv];
+  int over = 0;
+
+  for (int l = 0; l < 16; l++) {
+    fv[l*nv] = f[l];
+    fv[l*nv+1] = -f[l];
+  }
+  eno_bicubic_coeff(f, c);
+  eno_bicubic_coeff_batch(nv, fv, cv);
+  for (int k = 0; k < m; k++) {
+    t[k] = 0.25*(k % 5);
+    u[k] = 0.25*(k / 5);
+    for (int l = 0; l < 16; l++) {
+      cb[l*m+k] = c[l];
+    }
+  }
+  eno_bicubic_interpolate_batch(m, cb, t, u, false, p, NULL, NULL, NULL);
+  eno_bicubic_interpolate_batch(m, cb, t, u, true, pm, NULL, NULL, NULL);
+  for (int k = 0; k < m; k++) {
+    CU_ASSERT(pm[k] >= 0.0 && pm[k] <= 1.0);
+    if (p[k] < 0.0 || p[k] > 1.0) {
+      over++;
+    } else {
+      CU_ASSERT_EQUAL(pm[k], p[k]);
+    }
+    eno_bicubic_interpolate_multi(nv, cv, t[k], u[k], true, pv);
+    CU_ASSERT_DOUBLE_EQUAL(pv[0], pm[k], 1.0e-14);
+    CU_ASSERT_DOUBLE_EQUAL(pv[1], -pm[k], 1.0e-14);
+  }
+  CU_ASSERT(over > 0);
+}
+
 int main(void)
 {
   CU_pSuite s;
@@ -122,6 +221,8 @@ int main(void)
   CU_add_test(s, "linear_y", test_bicubic_linear_y);
   CU_add_test(s, "sincos",   test_bicubic_sincos);
   CU_add_test(s, "cossin",   test_bicubic_cossin);
+  CU_add_test(s, "batch",    test_bicubic_batch);
+  CU_add_test(s, "mono",     test_bicubic_mono);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
 //  CU_console_run_tests();
@@ -0,0 +1,229 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <math.h>
+#include "bicubic.h"
+#include "bicubic_grid.h"
+
+const int nx = 40;
+const int ny = 21;
+double x[nx], y[ny], f[nx*ny];
+
+void test_bicubic_grid_bilinear(void)
+{
+  const int n = 5;
+  double xo[n] = {0.0, 3.3, 17.25, 38.9, 39.0};
+  double yo[n] = {0.0, -9.5, 4.1, 1.0, 10.0};
+  double fo[n];
+  eno_bicubic_grid_t *grid;
+
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      f[j*nx+i] = 1.0 + 2.0*x[i] - 0.5*y[j] + 0.25*x[i]*y[j];
+    }
+  }
+  grid = eno_bicubic_grid_init(nx, ny, x, y, false);
+  eno_bicubic_grid_set(grid, f);
+  eno_bicubic_grid_interpolate(grid, n, xo, yo, fo);
+  for (int k = 0; k < n; k++) {
+#ifdef VERBOSE
+    printf("x=%f y=%f f=%f\n", xo[k], yo[k], fo[k]);
+#endif
+    CU_ASSERT_DOUBLE_EQUAL(fo[k], 1.0 + 2.0*xo[k] - 0.5*yo[k] + 0.25*xo[k]*yo[k], 1.0e-12);
+  }
+  eno_bicubic_grid_clean(grid);
+}
+
+void test_bicubic_grid_cell(void)
+{
+  const int n = 200;
+  double xo[n], yo[n], fe[n], fl[n];
+  eno_bicubic_grid_t *eager, *lazy;
+
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      f[j*nx+i] = sin(0.3*x[i])*cos(0.2*y[j]);
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    xo[k] = fmod(7.31*k, 39.0);
+    yo[k] = 10.0 - fmod(3.17*k, 20.0);
+  }
+  eager = eno_bicubic_grid_init(nx, ny, x, y, false);
+  lazy = eno_bicubic_grid_init(nx, ny, x, y, true);
+  eno_bicubic_grid_set(eager, f);
+  eno_bicubic_grid_set(lazy, f);
+  eno_bicubic_grid_interpolate(eager, n, xo, yo, fe);
+  eno_bicubic_grid_interpolate(lazy, n, xo, yo, fl);
+  for (int k = 0; k < n; k++) {
+    CU_ASSERT_EQUAL(fe[k], fl[k]);
+  }
+
+// compare with a single cell built by hand
+  int i = 5, j = 12;
+  int c[4][2] = {{i, j}, {i+1, j}, {i+1, j+1}, {i, j+1}};
+  double fc[16], cc[16];
+  for (int l = 0; l < 4; l++) {
+    int ic = c[l][0], jc = c[l][1];
+    fc[l]    = f[jc*nx+ic];
+    fc[l+4]  = 0.5*(f[jc*nx+ic+1] - f[jc*nx+ic-1]);
+    fc[l+8]  = 0.5*(f[(jc+1)*nx+ic] - f[(jc-1)*nx+ic]);
+    fc[l+12] = 0.25*(f[(jc+1)*nx+ic+1] - f[(jc-1)*nx+ic+1]
+                   - f[(jc+1)*nx+ic-1] + f[(jc-1)*nx+ic-1]);
+  }
+  eno_bicubic_coeff(fc, cc);
+  double xp = x[i] + 0.3, yp = y[j] - 0.6, fp;
+  eno_bicubic_grid_interpolate(lazy, 1, &xp, &yp, &fp);
+  CU_ASSERT_DOUBLE_EQUAL(fp, eno_bicubic_interpolate(cc, 0.3, 0.6), 1.0e-14);
+
+  eno_bicubic_grid_clean(eager);
+  eno_bicubic_grid_clean(lazy);
+}
+
+void test_bicubic_grid_multi(void)
+{
+  const int nv = 3;
+  const int n = 60;
+  double fv[nv*nx*ny], xo[n], yo[n], fo[nv*n], fg[n];
+  eno_bicubic_grid_t *grid;
+
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      f[j*nx+i] = sin(0.3*x[i])*cos(0.2*y[j]);
+      fv[(j*nx+i)*nv]   = f[j*nx+i];
+      fv[(j*nx+i)*nv+1] = x[i]*y[j];
+      fv[(j*nx+i)*nv+2] = -2.0*f[j*nx+i];
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    xo[k] = fmod(2.71*k, 39.0);
+    yo[k] = 10.0 - fmod(1.13*k, 20.0);
+  }
+  grid = eno_bicubic_grid_init(nx, ny, x, y, true);
+  eno_bicubic_grid_set(grid, f);
+  eno_bicubic_grid_interpolate(grid, n, xo, yo, fg);
+  eno_bicubic_grid_interpolate_multi(grid, nv, fv, NULL, false, n, xo, yo, fo);
+  for (int k = 0; k < n; k++) {
+    CU_ASSERT_DOUBLE_EQUAL(fo[k*nv], fg[k], 1.0e-14);
+    CU_ASSERT_DOUBLE_EQUAL(fo[k*nv+1], xo[k]*yo[k], 1.0e-12);
+    CU_ASSERT_DOUBLE_EQUAL(fo[k*nv+2], -2.0*fg[k], 1.0e-14);
+  }
+  eno_bicubic_grid_clean(grid);
+}
+
+/// solid-body rotation about the x-axis: u = -sin(lon)sin(lat), v = cos(lon)
+void test_bicubic_grid_sphere(void)
+{
+  const int nlon = 36;
+  const int nlat = 18;
+  const int n = 6;
+  const int nv = 3;
+  double lon[nlon], lat[nlat];
+  double ps[nlon*nlat], us[nlon*nlat], vs[nlon*nlat], fv[nv*nlon*nlat];
+  double sign[nv] = {1.0, -1.0, -1.0};
+  double xo[n] = {-5.0, 359.0, 123.0, 10.0, 200.0, 87.0};
+  double yo[n] = {89.0, 0.0, 86.0, -88.0, -89.5, 45.0};
+  double fo[n], go[n], ho[n], fm[nv*n];
+  eno_bicubic_grid_t *grid;
+
+  for (int i = 0; i < nlon; i++) {
+    lon[i] = 10.0*i;
+  }
+  for (int j = 0; j < nlat; j++) {
+    lat[j] = 85.0 - 10.0*j;
+  }
+  for (int j = 0; j < nlat; j++) {
+    for (int i = 0; i < nlon; i++) {
+      double rlon = lon[i]*M_PI/180.0, rlat = lat[j]*M_PI/180.0;
+      ps[j*nlon+i] = cos(rlat)*sin(rlon);
+      us[j*nlon+i] = -sin(rlon)*sin(rlat);
+      vs[j*nlon+i] = cos(rlon);
+      fv[(j*nlon+i)*nv]   = ps[j*nlon+i];
+      fv[(j*nlon+i)*nv+1] = us[j*nlon+i];
+      fv[(j*nlon+i)*nv+2] = vs[j*nlon+i];
+    }
+  }
+  grid = eno_bicubic_grid_init_sphere(nlon, nlat, lon, lat, 360.0, true);
+  eno_bicubic_grid_set(grid, ps);
+  eno_bicubic_grid_interpolate(grid, n, xo, yo, fo);
+  eno_bicubic_grid_set_vector(grid, us);
+  eno_bicubic_grid_interpolate(grid, n, xo, yo, go);
+  eno_bicubic_grid_set_vector(grid, vs);
+  eno_bicubic_grid_interpolate(grid, n, xo, yo, ho);
+  eno_bicubic_grid_interpolate_multi(grid, nv, fv, sign, false, n, xo, yo, fm);
+  for (int k = 0; k < n; k++) {
+    double rlon = xo[k]*M_PI/180.0, rlat = yo[k]*M_PI/180.0;
+#ifdef VERBOSE
+    printf("lon=%f lat=%f f=%f %f u=%f %f v=%f %f\n", xo[k], yo[k],
+      fo[k], cos(rlat)*sin(rlon), go[k], -sin(rlon)*sin(rlat), ho[k], cos(rlon));
+#endif
+    CU_ASSERT_DOUBLE_EQUAL(fo[k], cos(rlat)*sin(rlon), 2.0e-3);
+    CU_ASSERT_DOUBLE_EQUAL(go[k], -sin(rlon)*sin(rlat), 2.0e-3);
+    CU_ASSERT_DOUBLE_EQUAL(ho[k], cos(rlon), 2.0e-3);
+    CU_ASSERT_DOUBLE_EQUAL(fm[k*nv],   fo[k], 1.0e-14);
+    CU_ASSERT_DOUBLE_EQUAL(fm[k*nv+1], go[k], 1.0e-14);
+    CU_ASSERT_DOUBLE_EQUAL(fm[k*nv+2], ho[k], 1.0e-14);
+  }
+  eno_bicubic_grid_clean(grid);
+}
+
+/// node mapping across the periodic longitude and the poles
+void test_bicubic_grid_sphere_node(void)
+{
+  const int nx = 8;
+  const int ny = 4;
+  double x[nx], y[ny];
+  double pole[2] = {90.0, -90.0};
+
+  for (int i = 0; i < nx; i++) {
+    x[i] = 45.0*i;
+  }
+  for (int j = 0; j < ny; j++) {
+    y[j] = 67.5 - 45.0*j;
+  }
+  CU_ASSERT_DOUBLE_EQUAL(eno_bicubic_grid_sphere_x(nx, x, 360.0, -1), -45.0, 1.0e-12);
+  CU_ASSERT_DOUBLE_EQUAL(eno_bicubic_grid_sphere_x(nx, x, 360.0, nx+1), 405.0, 1.0e-12);
+  CU_ASSERT_DOUBLE_EQUAL(eno_bicubic_grid_sphere_y(ny, y, pole, -1), 112.5, 1.0e-12);
+  CU_ASSERT_DOUBLE_EQUAL(eno_bicubic_grid_sphere_y(ny, y, pole, ny+1), -157.5, 1.0e-12);
+  for (int j = -ny; j < 2*ny; j++) {
+    for (int i = -nx; i < 2*nx; i++) {
+      int im = i, jm = j;
+      double s = eno_bicubic_grid_sphere_node(nx, ny, &im, &jm);
+      CU_ASSERT(im >= 0 && im < nx && jm >= 0 && jm < ny);
+      CU_ASSERT_EQUAL(s, (j < 0 || j >= ny) ? -1.0 : 1.0);
+// the node lies at the same point of the sphere
+      double lon = eno_bicubic_grid_sphere_x(nx, x, 360.0, i);
+      double lat = eno_bicubic_grid_sphere_y(ny, y, pole, j);
+      if (lat > 90.0 || lat < -90.0) {
+        lat = (lat > 0.0 ? 180.0 : -180.0) - lat;
+        lon += 180.0;
+      }
+      CU_ASSERT_DOUBLE_EQUAL(lat, y[jm], 1.0e-12);
+      CU_ASSERT_DOUBLE_EQUAL(fmod(lon - x[im] + 720.0, 360.0), 0.0, 1.0e-12);
+    }
+  }
+}
+
+int main(void)
+{
+  CU_pSuite s;
+
+  for (int i = 0; i < nx; i++) {
+    x[i] = i;
+  }
+  for (int j = 0; j < ny; j++) {
+    y[j] = 10.0 - j;
+  }
+  CU_initialize_registry();
+  s = CU_add_suite("bicubic_grid", NULL, NULL);
+  CU_add_test(s, "bilinear", test_bicubic_grid_bilinear);
+  CU_add_test(s, "cell", test_bicubic_grid_cell);
+  CU_add_test(s, "multi", test_bicubic_grid_multi);
+  CU_add_test(s, "sphere", test_bicubic_grid_sphere);
+  CU_add_test(s, "sphere_node", test_bicubic_grid_sphere_node);
+  CU_basic_set_mode(CU_BRM_VERBOSE);
+  CU_basic_run_tests();
+  CU_cleanup_registry();
+
+  return 0;
+}
@@ -35,10 +35,28 @@ void test_biquadratic(double f[9], double d[9], double gx[9], double gy[9], doub
     CU_ASSERT_EQUAL(px,  gx[i]);
     CU_ASSERT_EQUAL(py,  gy[i]);
     CU_ASSERT_EQUAL(pxy, gxy[i]);
+    eno_biquadratic_interpolate_fused(c, t[i], u[i], &p, &px, &py, &pxy);
+    CU_ASSERT_EQUAL(p,   f[i]);
+    CU_ASSERT_EQUAL(px,  gx[i]);
+    CU_ASSERT_EQUAL(py,  gy[i]);
+    CU_ASSERT_EQUAL(pxy, gxy[i]);
 #ifdef VERBOSE
     printf("t=%f, u=%f, p=%f, f=%f, px=%f, gx=%f, py=%f, gy=%f, pxy=%f, gxy=%f\n", t[i], u[i], p, f[i], px, gx[i], py, gy[i], pxy, gxy[i]);
 #endif
   }
+
+  double cb[9*9], pb[9], pxb[9], pyb[9];
+  for (int l=0; l<9; l++) {
+    for (int i=0; i<9; i++) {
+      cb[l*9+i] = c[l];
+    }
+  }
+  eno_biquadratic_interpolate_batch(9, cb, t, u, pb, pxb, pyb, NULL);
+  for (int i=0; i<9; i++) {
+    CU_ASSERT_EQUAL(pb[i],  f[i]);
+    CU_ASSERT_EQUAL(pxb[i], gx[i]);
+    CU_ASSERT_EQUAL(pyb[i], gy[i]);
+  }
 }
 
 void test_biquadratic_constant(void)
@@ -104,6 +122,37 @@ void test_biquadratic_cossin(void)
   test_biquadratic(f, d, gx, gy, gxy);
 }
 
+void test_biquadratic_grid(void)
+{
+  const int nx = 9;
+  const int ny = 7;
+  const int nv = 2;
+  const int n = 20;
+  double x[nx], y[ny], f[ny*nx*nv], xo[n], yo[n], fo[n*nv];
+
+  for (int i=0; i<nx; i++) {
+    x[i] = 0.5*i;
+  }
+  for (int j=0; j<ny; j++) {
+    y[j] = 3.0 - j;
+  }
+  for (int j=0; j<ny; j++) {
+    for (int i=0; i<nx; i++) {
+      f[(j*nx+i)*nv]   = (1.0 + x[i] - x[i]*x[i]) * (2.0 + y[j]*y[j]);
+      f[(j*nx+i)*nv+1] = x[i] - 3.0*y[j];
+    }
+  }
+  for (int k=0; k<n; k++) {
+    xo[k] = 0.21*k;
+    yo[k] = 3.0 - 0.29*k;
+  }
+  eno_biquadratic_interpolate_grid(nx, ny, x, y, nv, f, n, xo, yo, fo);
+  for (int k=0; k<n; k++) {
+    CU_ASSERT_DOUBLE_EQUAL(fo[k*nv], (1.0 + xo[k] - xo[k]*xo[k]) * (2.0 + yo[k]*yo[k]), 1.0e-12);
+    CU_ASSERT_DOUBLE_EQUAL(fo[k*nv+1], xo[k] - 3.0*yo[k], 1.0e-12);
+  }
+}
+
 int main(void)
 {
   CU_pSuite s;
@@ -115,6 +164,7 @@ int main(void)
   CU_add_test(s, "linear_y", test_biquadratic_linear_y);
   CU_add_test(s, "sincos",   test_biquadratic_sincos);
   CU_add_test(s, "cossin",   test_biquadratic_cossin);
+  CU_add_test(s, "grid",     test_biquadratic_grid);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
 //  CU_console_run_tests();
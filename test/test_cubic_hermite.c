@@ -1,6 +1,8 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
 //#include <CUnit/Console.h>
+#include <stdbool.h>
+#include <math.h>
 #include "cubic_hermite.h"
 
 void test_cubic_hermite(double f[4], double d[4], double g[3], double gx[3])
@@ -70,6 +72,121 @@ void test_cubic_hermite_cos(void)
   test_cubic_hermite(f, d, g, gx);
 }
 
+/// weights with centred differences agree with eno_cubic_hermite_coeff() and sum to one
+void test_cubic_hermite_weights(void)
+{
+  const int n = 6;
+  double x[n] = {0.0, 0.4, 1.0, 1.5, 2.3, 3.0};
+  double f[n], w[4], fd[4], c[4];
+
+  for (int i = 0; i < n; i++) {
+    f[i] = sin(x[i]);
+  }
+  for (int i = 0; i < n-1; i++) {
+    int im = i > 0 ? i-1 : 0;
+    int ip = i+2 < n ? i+2 : n-1;
+    double dx = x[i+1] - x[i];
+    fd[0] = f[i];
+    fd[1] = f[i+1];
+    fd[2] = (f[i+1] - f[im]) / (x[i+1] - x[im]) * dx;
+    fd[3] = (f[ip] - f[i]) / (x[ip] - x[i]) * dx;
+    eno_cubic_hermite_coeff(fd, c);
+    for (int l = 0; l <= 4; l++) {
+      double t = 0.25*l;
+      double fw = 0.0;
+      eno_cubic_hermite_weights(x, n, i, t, w);
+      for (int a = 0; a < 4; a++) {
+        if (i+a-1 >= 0 && i+a-1 < n) {
+          fw += w[a]*f[i+a-1];
+        } else {
+          CU_ASSERT_EQUAL(w[a], 0.0);
+        }
+      }
+      CU_ASSERT_DOUBLE_EQUAL(w[0]+w[1]+w[2]+w[3], 1.0, 1.0e-15);
+      CU_ASSERT_DOUBLE_EQUAL(fw, eno_cubic_hermite_interpolate(c, t), 1.0e-15);
+    }
+  }
+}
+
+/// columns with non-uniform, ascending and descending nodes
+void test_cubic_hermite_column(void)
+{
+  const int nlev = 9;
+  const int ncol = 3;
+  const int nt = 7;
+  double x[nlev*ncol], f[nlev*ncol], d[nlev*ncol], xt[nt*ncol], ft[nt*ncol];
+  double q[nt*ncol];
+
+  for (int k = 0; k < nlev; k++) {
+    x[k*ncol]   = k;
+    x[k*ncol+1] = k + 0.03*k*k;
+    x[k*ncol+2] = 1000.0 - 110.0*k - k*k;
+  }
+  for (int l = 0; l < nt; l++) {
+    for (int c = 0; c < ncol; c++) {
+      double x0 = x[c], x1 = x[(nlev-1)*ncol+c];
+      xt[l*ncol+c] = x0 + (x1 - x0)*(0.02 + 0.16*l);
+    }
+  }
+// finite difference is exact for quadratics
+  for (int k = 0; k < nlev*ncol; k++) {
+    f[k] = 1.0 + 0.5*x[k] - 0.01*x[k]*x[k];
+  }
+  for (int l = 0; l < nt*ncol; l++) {
+    q[l] = 1.0 + 0.5*xt[l] - 0.01*xt[l]*xt[l];
+  }
+  eno_cubic_hermite_column_deriv(HERMITE_FD, nlev, ncol, x, f, d);
+  eno_cubic_hermite_column_interpolate(nlev, ncol, x, f, d, nt, xt, ft);
+  for (int l = 0; l < nt*ncol; l++) {
+    CU_ASSERT_DOUBLE_EQUAL(ft[l], q[l], 1.0e-10*fabs(q[l]));
+  }
+// all methods are exact for linear functions
+  int method[3] = {HERMITE_CR, HERMITE_PCHIP, HERMITE_SPLINE};
+  for (int k = 0; k < nlev*ncol; k++) {
+    f[k] = 2.0 - 0.25*x[k];
+  }
+  for (int m = 0; m < 3; m++) {
+    eno_cubic_hermite_column_deriv(method[m], nlev, ncol, x, f, d);
+    eno_cubic_hermite_column_interpolate(nlev, ncol, x, f, d, nt, xt, ft);
+    for (int l = 0; l < nt*ncol; l++) {
+      CU_ASSERT_DOUBLE_EQUAL(ft[l], 2.0 - 0.25*xt[l], 1.0e-12);
+    }
+  }
+// natural spline has continuous second derivatives and zero at the ends
+  for (int k = 0; k < nlev*ncol; k++) {
+    f[k] = sin(0.01*x[k]);
+  }
+  eno_cubic_hermite_column_deriv(HERMITE_SPLINE, nlev, ncol, x, f, d);
+  for (int c = 0; c < ncol; c++) {
+    for (int k = 0; k < nlev; k++) {
+      double fl = 0.0, fr = 0.0;
+      if (k > 0) {
+        double h = x[k*ncol+c] - x[(k-1)*ncol+c];
+        double s = (f[k*ncol+c] - f[(k-1)*ncol+c]) / h;
+        fl = (2.0*d[(k-1)*ncol+c] + 4.0*d[k*ncol+c] - 6.0*s) / h;
+      }
+      if (k < nlev-1) {
+        double h = x[(k+1)*ncol+c] - x[k*ncol+c];
+        double s = (f[(k+1)*ncol+c] - f[k*ncol+c]) / h;
+        fr = (6.0*s - 4.0*d[k*ncol+c] - 2.0*d[(k+1)*ncol+c]) / h;
+      }
+      CU_ASSERT_DOUBLE_EQUAL(fl, fr, 1.0e-12);
+    }
+  }
+// PCHIP keeps a step monotone
+  for (int k = 0; k < nlev*ncol; k++) {
+    f[k] = (k/ncol < 4) ? 0.0 : 1.0;
+  }
+  eno_cubic_hermite_column_deriv(HERMITE_PCHIP, nlev, ncol, x, f, d);
+  eno_cubic_hermite_column_interpolate(nlev, ncol, x, f, d, nt, xt, ft);
+  for (int l = 0; l < nt*ncol; l++) {
+    CU_ASSERT(ft[l] >= 0.0 && ft[l] <= 1.0);
+    if (l >= ncol) {
+      CU_ASSERT(ft[l] >= ft[l-ncol]);
+    }
+  }
+}
+
 int main(void)
 {
   CU_pSuite s;
@@ -79,6 +196,8 @@ int main(void)
   CU_add_test(s, "constant", test_cubic_hermite_constant);
   CU_add_test(s, "linear", test_cubic_hermite_linear);
   CU_add_test(s, "cos",   test_cubic_hermite_cos);
+  CU_add_test(s, "weights", test_cubic_hermite_weights);
+  CU_add_test(s, "column", test_cubic_hermite_column);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
 //  CU_console_run_tests();
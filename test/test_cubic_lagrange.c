@@ -1,14 +1,19 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
 //#include <CUnit/Console.h>
+#include <math.h>
 #include "cubic_lagrange.h"
 
 void test_cubic_lagrange(double xa[4], double ya[4], double g[3])
 {
   double t[3] = {0.0, 0.5, 1.0};
 
+  double w[4];
+
   for (int i=0; i<3; i++) {
     CU_ASSERT_EQUAL(eno_cubic_lagrange(xa, ya, t[i]), g[i]);
+    eno_cubic_lagrange_weights(xa, t[i], w);
+    CU_ASSERT_DOUBLE_EQUAL(w[0]*ya[0]+w[1]*ya[1]+w[2]*ya[2]+w[3]*ya[3], g[i], 1.0e-15);
   }
 }
 
@@ -42,6 +47,33 @@ void test_cubic_lagrange_cos(void)
   test_cubic_lagrange(xa, ya, g);
 }
 
+/// barycentric weights on a non-uniform grid reproduce cubics in every column
+void test_cubic_lagrange_bary(void)
+{
+  const int n = 10;
+  const int nt = 6;
+  const int ncol = 3;
+  double x[n], wb[4*(n-3)], f[n*ncol], ft[nt*ncol];
+  double xt[nt] = {0.99, 0.9, 0.5, 0.2, 0.05, 0.01};
+
+  for (int k = 0; k < n; k++) {
+    x[k] = 1.0 - pow((double)k/(n-1), 2.0);
+    for (int c = 0; c < ncol; c++) {
+      f[k*ncol+c] = 1.0 + c*x[k]*(1.0 - 2.0*x[k]*x[k]);
+    }
+  }
+  eno_cubic_lagrange_bary_init(n, x, wb);
+  eno_cubic_lagrange_bary(n, x, wb, nt, xt, ncol, f, ft);
+  for (int l = 0; l < nt; l++) {
+    for (int c = 0; c < ncol; c++) {
+      CU_ASSERT_DOUBLE_EQUAL(ft[l*ncol+c], 1.0 + c*xt[l]*(1.0 - 2.0*xt[l]*xt[l]), 1.0e-13);
+    }
+    int s = MAX(0, MIN(n-4, eno_search_bisection(x, n, xt[l]) - 1));
+    double ya[4] = {f[s*ncol+2], f[(s+1)*ncol+2], f[(s+2)*ncol+2], f[(s+3)*ncol+2]};
+    CU_ASSERT_DOUBLE_EQUAL(ft[l*ncol+2], eno_cubic_lagrange(&x[s], ya, xt[l]), 1.0e-14);
+  }
+}
+
 int main(void)
 {
   CU_pSuite s;
@@ -51,6 +83,7 @@ int main(void)
   CU_add_test(s, "constant", test_cubic_lagrange_constant);
   CU_add_test(s, "linear", test_cubic_lagrange_linear);
   CU_add_test(s, "cos",   test_cubic_lagrange_cos);
+  CU_add_test(s, "bary", test_cubic_lagrange_bary);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
 //  CU_console_run_tests();
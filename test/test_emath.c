@@ -1,5 +1,6 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
+#include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
 #include "emath.h"
@@ -18,6 +19,66 @@ void test_emath_pow(void)
   CU_ASSERT_EQUAL(pow(2.0, -3.0), ipow(2.0, -3));
 }
 
+/// elog() agrees with log() to the requested accuracy
+void test_emath_log(void)
+{
+  const int n = 2000;
+  double x[n], y[n], z[n];
+
+  for (int i = 0; i < n; i++) {
+    x[i] = exp(-300.0 + 600.0*i/(n-1)) * (1.0 + 0.37*(i%7));
+  }
+  x[0] = 1.0;
+  x[1] = 1.0 + 1.0e-12;
+  x[2] = M_SQRT2;
+  elogv(n, x, y, ELOG_FULL);
+  elogv(n, x, z, ELOG_FAST);
+  double efull = 0.0, efast = 0.0;
+  for (int i = 0; i < n; i++) {
+    double l = log(x[i]);
+    double scale = fmax(fabs(l), 1.0e-300);
+    efull = fmax(efull, fabs(y[i] - l)/scale);
+    efast = fmax(efast, fabs(z[i] - l)/scale);
+    CU_ASSERT_EQUAL(y[i], elog(x[i], ELOG_FULL));
+    CU_ASSERT_EQUAL(z[i], elog(x[i], ELOG_FAST));
+  }
+#ifdef VERBOSE
+  printf("relative error full=%e fast=%e\n", efull, efast);
+#endif
+  CU_ASSERT(efull < 1.0e-15);
+  CU_ASSERT(efast < 1.0e-10);
+  CU_ASSERT_EQUAL(y[0], 0.0);
+}
+
+void test_emath_exp(void)
+{
+  const int n = 2000;
+  double x[n], y[n], z[n];
+
+  for (int i = 0; i < n; i++) {
+    x[i] = -700.0 + 1400.0*i/(n-1) + 0.013*(i%7);
+  }
+  x[0] = 0.0;
+  x[1] = 1.0e-12;
+  x[2] = M_LN2/2;
+  eexpv(n, x, y, EEXP_FULL);
+  eexpv(n, x, z, EEXP_FAST);
+  double efull = 0.0, efast = 0.0;
+  for (int i = 0; i < n; i++) {
+    double e = exp(x[i]);
+    efull = fmax(efull, fabs(y[i] - e)/e);
+    efast = fmax(efast, fabs(z[i] - e)/e);
+    CU_ASSERT_EQUAL(y[i], eexp(x[i], EEXP_FULL));
+    CU_ASSERT_EQUAL(z[i], eexp(x[i], EEXP_FAST));
+  }
+#ifdef VERBOSE
+  printf("relative error full=%e fast=%e\n", efull, efast);
+#endif
+  CU_ASSERT(efull < 1.0e-15);
+  CU_ASSERT(efast < 1.0e-10);
+  CU_ASSERT_EQUAL(y[0], 1.0);
+}
+
 int main(void) {
   CU_pSuite s;
 
@@ -25,6 +86,8 @@ int main(void) {
   s = CU_add_suite("emath", NULL, NULL);
   CU_add_test(s, "test_mod", test_emath_mod);
   CU_add_test(s, "test_pow", test_emath_pow);
+  CU_add_test(s, "test_log", test_emath_log);
+  CU_add_test(s, "test_exp", test_emath_exp);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
   CU_cleanup_registry();
@@ -1,5 +1,6 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
+#include <stdbool.h>
 #include "extrapolate.h"
 
 void test_extrapolate(void)
@@ -24,12 +25,56 @@ void test_extrapolate(void)
   CU_ASSERT(T2000 < T1);
 }
 
+/// masked targets agree with the scalar functions, others are untouched
+void test_extrapolate_grid(void)
+{
+  const int nlev = 4;
+  const int ncol = 301;
+  double zs[ncol], Tl[ncol], sigl[ncol], Ts[ncol];
+  double sig[nlev*ncol], z[nlev*ncol], T[nlev*ncol];
+  bool mask[nlev*ncol];
+
+  for (int c = 0; c < ncol; c++) {
+    zs[c] = 10.0*c;
+    Tl[c] = 300.0 - 0.1*c;
+    sigl[c] = 0.99;
+  }
+  eno_extrapolate_Ts_grid(ncol, Tl, sigl, Ts);
+  for (int c = 0; c < ncol; c++) {
+    CU_ASSERT_DOUBLE_EQUAL(Ts[c], eno_extrapolate_Ts(Tl[c], sigl[c]), 1.0e-12);
+  }
+  for (int k = 0; k < nlev; k++) {
+    for (int c = 0; c < ncol; c++) {
+      int i = k*ncol+c;
+      sig[i] = 1.0 + 0.1*k;
+      mask[i] = (k > 0) && ((c*7 + k) % 5 == 0);
+      z[i] = -1.0;
+      T[i] = -1.0;
+    }
+  }
+  eno_extrapolate_z_grid(nlev, ncol, zs, Ts, sig, mask, z);
+  eno_extrapolate_T_grid(nlev, ncol, zs, Ts, sig, mask, T);
+  for (int k = 0; k < nlev; k++) {
+    for (int c = 0; c < ncol; c++) {
+      int i = k*ncol+c;
+      if (mask[i]) {
+        CU_ASSERT_DOUBLE_EQUAL(z[i], eno_extrapolate_z(zs[c], Ts[c], sig[i]), 1.0e-10);
+        CU_ASSERT_DOUBLE_EQUAL(T[i], eno_extrapolate_T(zs[c], Ts[c], sig[i]), 1.0e-11);
+      } else {
+        CU_ASSERT_EQUAL(z[i], -1.0);
+        CU_ASSERT_EQUAL(T[i], -1.0);
+      }
+    }
+  }
+}
+
 int main(void) {
   CU_pSuite s;
 
   CU_initialize_registry();
   s = CU_add_suite("extrapolate", NULL, NULL);
   CU_add_test(s, "test_extrapolate", test_extrapolate);
+  CU_add_test(s, "test_extrapolate_grid", test_extrapolate_grid);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
   CU_cleanup_registry();
@@ -1,6 +1,10 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
 #include "air.h"
+#include "emath.h"
 #include "moist.h"
 
 void test_moist(void)
@@ -12,12 +16,81 @@ void test_moist(void)
   CU_ASSERT_EQUAL(Tv, T*(1.0+(1.0-eps)/eps*q));
 }
 
+/// kernels agree with the formulas evaluated by libm and invert each other
+void test_moist_grid(void)
+{
+  const int n = 1000;
+  const double T0 = eno_air_T0;
+  const double eps = eno_air_eps;
+  double p[n], T[n], q[n], rh[n], es[n], esf[n], esg[n], ws[n], Td[n], Tv[n], th[n], thf[n];
+
+  for (int i = 0; i < n; i++) {
+    p[i] = 100000.0 - 50.0*i;
+    T[i] = 230.0 + 0.08*i;
+    rh[i] = 0.05 + 0.95*(i%11)/10.0;
+  }
+  eno_moist_calc_es(n, MOIST_TETENS, EEXP_FULL, T, es);
+  eno_moist_calc_es(n, MOIST_TETENS, EEXP_FAST, T, esf);
+  eno_moist_calc_es(n, MOIST_GOFF_GRATCH, EEXP_FULL, T, esg);
+  eno_moist_calc_ws(n, p, es, ws);
+  eno_moist_calc_q(n, p, es, rh, q);
+  eno_moist_calc_Tv_grid(n, T, q, Tv);
+  for (int i = 0; i < n; i++) {
+    double e = 610.78*exp(17.27*(T[i] - T0)/(T[i] - 35.86));
+    CU_ASSERT_DOUBLE_EQUAL(es[i], e, 1.0e-14*e);
+    CU_ASSERT_DOUBLE_EQUAL(esf[i], e, 1.0e-9*e);
+    double r = 373.16/T[i];
+    e = 1013.246e2*pow(10.0, -7.90298*(r - 1.0) + 5.02808*log10(r)
+      - 1.3816e-7*(pow(10.0, 11.344*(1.0 - 1.0/r)) - 1.0)
+      + 8.1328e-3*(pow(10.0, -3.49149*(r - 1.0)) - 1.0));
+    CU_ASSERT_DOUBLE_EQUAL(esg[i], e, 1.0e-13*e);
+    CU_ASSERT_DOUBLE_EQUAL(ws[i], eps*es[i]/(p[i] - es[i]), 1.0e-15*ws[i]);
+    CU_ASSERT_DOUBLE_EQUAL(Tv[i], eno_moist_calc_Tv(T[i], q[i]), 1.0e-12);
+  }
+// Tetens and Goff-Gratch are close near the triple point
+  double Tt = 273.16;
+  eno_moist_calc_es(1, MOIST_TETENS, EEXP_FULL, &Tt, es);
+  eno_moist_calc_es(1, MOIST_GOFF_GRATCH, EEXP_FULL, &Tt, esg);
+  CU_ASSERT_DOUBLE_EQUAL(es[0], 611.66, 1.0);
+  CU_ASSERT_DOUBLE_EQUAL(esg[0], 611.66, 1.0);
+// relative humidity and dew point invert specific humidity
+  eno_moist_calc_es(n, MOIST_TETENS, EEXP_FULL, T, es);
+  eno_moist_calc_rh(n, p, es, q, esf);
+  eno_moist_calc_Td(n, EEXP_FULL, p, q, Td);
+  for (int i = 0; i < n; i++) {
+    CU_ASSERT_DOUBLE_EQUAL(esf[i], rh[i], 1.0e-14);
+    CU_ASSERT(Td[i] <= T[i] + 1.0e-9);
+    if (rh[i] == 1.0) {
+      CU_ASSERT_DOUBLE_EQUAL(Td[i], T[i], 1.0e-9);
+    }
+  }
+// Bolton (1980)
+  eno_moist_calc_thetae(n, EEXP_FULL, p, T, q, th);
+  eno_moist_calc_thetae(n, EEXP_FAST, p, T, q, thf);
+  double emax = 0.0;
+  for (int i = 0; i < n; i++) {
+    double e = q[i]*p[i]/(eps + (1.0-eps)*q[i])*1.0e-2;
+    double r = 1.0e3*q[i]/(1.0 - q[i]);
+    double TL = 2840.0/(3.5*log(T[i]) - log(e) - 4.805) + 55.0;
+    double t = T[i]*pow(1000.0e2/p[i], eno_air_kappa*(1.0 - 0.28e-3*r))
+      * exp((3.376/TL - 0.00254)*r*(1.0 + 0.81e-3*r));
+    CU_ASSERT_DOUBLE_EQUAL(th[i], t, 1.0e-13*t);
+    CU_ASSERT_DOUBLE_EQUAL(thf[i], t, 1.0e-8*t);
+    CU_ASSERT(th[i] > T[i]*pow(1000.0e2/p[i], eno_air_kappa));
+    emax = fmax(emax, fabs(thf[i] - t)/t);
+  }
+#ifdef VERBOSE
+  printf("relative error of fast thetae=%e\n", emax);
+#endif
+}
+
 int main(void) {
   CU_pSuite s;
 
   CU_initialize_registry();
   s = CU_add_suite("moist", NULL, NULL);
   CU_add_test(s, "test_moist", test_moist);
+  CU_add_test(s, "test_moist_grid", test_moist_grid);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
   CU_cleanup_registry();
@@ -0,0 +1,222 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include "air.h"
+#include "emath.h"
+#include "moist.h"
+#include "parcel.h"
+
+/// environment with lapse rate 6.5 K/km up to 200 hPa and moisture decreasing with height
+static void sounding(int n, int ncol, double *pf, double *T, double *q)
+{
+  const double ps = 1000.0e2;
+
+  for (int c = 0; c < ncol; c++) {
+    double Ts = 285.0 + 20.0*c/(ncol - 1);
+    double qs = 6.0e-3 + 14.0e-3*c/(ncol - 1);
+    for (int k = 1; k < n+1; k++) {
+      int i = k*ncol+c;
+      pf[i] = 0.99*ps*k/n;
+      T[i] = Ts*pow(MAX(pf[i], 200.0e2)/ps, eno_air_Rd*6.5e-3/9.80665);
+      q[i] = MAX(qs*pow(pf[i]/ps, 3.0), 1.0e-6);
+    }
+  }
+// isothermal and dry, stable
+  for (int k = 1; k < n+1; k++) {
+    T[k*ncol] = 250.0;
+    q[k*ncol] = 1.0e-5;
+  }
+}
+
+void test_parcel_cape(void)
+{
+  const int n = 40;
+  const int ncol = 300;
+  const double pmin = 100.0e2;
+  double pf[(n+1)*ncol], T[(n+1)*ncol], q[(n+1)*ncol];
+  double plcl[ncol], plfc[ncol], cape[ncol], cin[ncol];
+  double plclf[ncol], plfcf[ncol], capef[ncol], cinf[ncol];
+
+  sounding(n, ncol, pf, T, q);
+  eno_parcel_cape(n, ncol, pf, T, q, pmin, EEXP_FULL, plcl, plfc, cape, cin);
+  eno_parcel_cape(n, ncol, pf, T, q, pmin, EEXP_FAST, plclf, plfcf, capef, cinf);
+  CU_ASSERT_EQUAL(cape[0], 0.0);
+  CU_ASSERT_EQUAL(cin[0], 0.0);
+  CU_ASSERT_EQUAL(plfc[0], 0.0);
+  for (int c = 0; c < ncol; c++) {
+    double p = pf[n*ncol+c], Tn = T[n*ncol+c], qn = q[n*ncol+c];
+    double e = qn*p/(eno_air_eps + (1.0-eno_air_eps)*qn)*1.0e-2;
+    double TL = 2840.0/(3.5*log(Tn) - log(e) - 4.805) + 55.0;
+    double pl = p*pow(TL/Tn, 1.0/eno_air_kappa);
+    CU_ASSERT_DOUBLE_EQUAL(plcl[c], pl, 1.0e-10*pl);
+    CU_ASSERT(cape[c] >= 0.0);
+    CU_ASSERT(cin[c] <= 0.0);
+    if (cape[c] > 0.0) {
+      CU_ASSERT(plfc[c] <= plcl[c] && plfc[c] > pmin);
+    }
+    CU_ASSERT_DOUBLE_EQUAL(capef[c], cape[c], 1.0e-6*cape[c] + 1.0e-6);
+    CU_ASSERT_DOUBLE_EQUAL(cinf[c], cin[c], 1.0e-6*fabs(cin[c]) + 1.0e-6);
+  }
+// warm moist columns are more unstable
+  CU_ASSERT(cape[ncol-1] > 1000.0);
+  CU_ASSERT(cape[ncol-1] > cape[ncol/2]);
+#ifdef VERBOSE
+  for (int c = 0; c < ncol; c += ncol/6) {
+    printf("c=%d plcl=%f plfc=%f cape=%f cin=%f\n", c, plcl[c], plfc[c], cape[c], cin[c]);
+  }
+#endif
+// a column alone gives the same result
+  for (int c = 1; c < ncol; c += 37) {
+    double pc[n+1], Tc[n+1], qc[n+1];
+    double plclc, plfcc, capec, cinc;
+    for (int k = 1; k < n+1; k++) {
+      pc[k] = pf[k*ncol+c];
+      Tc[k] = T[k*ncol+c];
+      qc[k] = q[k*ncol+c];
+    }
+    eno_parcel_cape(n, 1, pc, Tc, qc, pmin, EEXP_FULL, &plclc, &plfcc, &capec, &cinc);
+    CU_ASSERT_DOUBLE_EQUAL(plclc, plcl[c], 1.0e-12*plcl[c]);
+    CU_ASSERT_DOUBLE_EQUAL(plfcc, plfc[c], 1.0e-12*plfc[c]);
+    CU_ASSERT_DOUBLE_EQUAL(capec, cape[c], 1.0e-12*cape[c]);
+    CU_ASSERT_DOUBLE_EQUAL(cinc, cin[c], 1.0e-12*fabs(cin[c]));
+  }
+}
+
+/// saturated specific humidity at p and T
+static double qsat(double p, double T)
+{
+  double es, ws;
+
+  eno_moist_calc_es(1, MOIST_TETENS, EEXP_FULL, &T, &es);
+  eno_moist_calc_ws(1, &p, &es, &ws);
+  return ws/(1.0 + ws);
+}
+
+/// four Newton iterations from 10 K off conserve theta-e of eno_moist_calc_thetae()
+void test_parcel_newton(void)
+{
+  const int n = 400;
+  double p[n], T[n], Tt[n], q[n], th[n], thp[n];
+
+  for (int i = 0; i < n; i++) {
+    p[i] = 1000.0e2 - 200.0*i;
+    Tt[i] = 303.0 - 0.2*i;
+    q[i] = qsat(p[i], Tt[i]);
+    T[i] = Tt[i] + ((i%2) ? 10.0 : -10.0);
+  }
+  eno_moist_calc_thetae(n, EEXP_FULL, p, Tt, q, th);
+  eno_parcel_calc_T(n, EEXP_FULL, 4, p, th, T);
+  for (int i = 0; i < n; i++) {
+    q[i] = qsat(p[i], T[i]);
+  }
+  eno_moist_calc_thetae(n, EEXP_FULL, p, T, q, thp);
+  double emax = 0.0;
+  for (int i = 0; i < n; i++) {
+    emax = fmax(emax, fabs(thp[i] - th[i])/th[i]);
+    CU_ASSERT_DOUBLE_EQUAL(T[i], Tt[i], 1.0e-8);
+  }
+#ifdef VERBOSE
+  printf("relative residual of theta-e=%e\n", emax);
+#endif
+  CU_ASSERT(emax < 1.0e-10);
+}
+
+/// environment on the parcel path with Tv lowered by d above the LCL
+void test_parcel_analytic(void)
+{
+  const int n = 40;
+  const int ncol = 2;
+  const double pmin = 100.0e2;
+  const double d[2] = {0.0, 0.5};
+  const double cv = (1.0-eno_air_eps)/eno_air_eps;
+  double pf[(n+1)*ncol], T[(n+1)*ncol], q[(n+1)*ncol];
+  double plcl[ncol], plfc[ncol], cape[ncol], cin[ncol];
+
+  for (int k = 1; k < n+1; k++) {
+    for (int c = 0; c < ncol; c++) {
+      pf[k*ncol+c] = 990.0e2*k/n;
+      T[k*ncol+c] = 300.0;
+      q[k*ncol+c] = 15.0e-3;
+    }
+  }
+  eno_parcel_cape(n, ncol, pf, T, q, pmin, EEXP_FULL, plcl, plfc, cape, cin);
+  double pn = pf[n*ncol], th, Tp = 300.0;
+  eno_moist_calc_thetae(1, EEXP_FULL, &pn, &T[n*ncol], &q[n*ncol], &th);
+  int km = 0;
+  for (int k = n-1; k >= 1; k--) {
+    double p = pf[k*ncol];
+    double Td = 300.0*pow(p/pn, eno_air_kappa);
+    Tp = (p < plcl[0]) ? Tp : Td;
+    eno_parcel_calc_T(1, EEXP_FULL, 10, &p, &th, &Tp);
+    double qp = qsat(p, Tp);
+    km = (p < plcl[0]) ? MAX(km, k) : km;
+    for (int c = 0; c < ncol; c++) {
+      if (p < plcl[0]) {
+        T[k*ncol+c] = Tp*(1.0 + cv*qp) - d[c];
+        q[k*ncol+c] = 0.0;
+      } else {
+        T[k*ncol+c] = Td;
+      }
+    }
+  }
+  eno_parcel_cape(n, ncol, pf, T, q, pmin, EEXP_FULL, plcl, plfc, cape, cin);
+  CU_ASSERT(cape[0] < 1.0e-6);
+  CU_ASSERT(cin[0] > -1.0e-6);
+// constant buoyancy d from the LCL to pmin
+  double l0 = log(pf[(km+1)*ncol]), l1 = log(pf[km*ncol]);
+  double c1 = eno_air_Rd*d[1]*(0.5*(l0 - l1) + l1 - log(pmin));
+  CU_ASSERT_DOUBLE_EQUAL(cape[1], c1, 1.0e-6*c1);
+  CU_ASSERT(cin[1] > -1.0e-6);
+  CU_ASSERT_DOUBLE_EQUAL(plfc[1], plcl[1], 1.0e-6*plcl[1]);
+#ifdef VERBOSE
+  printf("cape=%f %f expected %f, cin=%e %e\n", cape[0], cape[1], c1, cin[0], cin[1]);
+#endif
+}
+
+/// CAPE and CIN converge as the levels are refined
+void test_parcel_refine(void)
+{
+  const int n = 40;
+  const int m = 640;
+  const int ncol = 300;
+  const double pmin = 100.0e2;
+  double pf[(m+1)*ncol], T[(m+1)*ncol], q[(m+1)*ncol];
+  double plcl[ncol], plfc[ncol], cape[ncol], cin[ncol];
+  double plclm[ncol], plfcm[ncol], capem[ncol], cinm[ncol];
+
+  sounding(n, ncol, pf, T, q);
+  eno_parcel_cape(n, ncol, pf, T, q, pmin, EEXP_FULL, plcl, plfc, cape, cin);
+  sounding(m, ncol, pf, T, q);
+  eno_parcel_cape(m, ncol, pf, T, q, pmin, EEXP_FULL, plclm, plfcm, capem, cinm);
+  double ecape = 0.0, ecin = 0.0;
+  for (int c = 0; c < ncol; c++) {
+    CU_ASSERT_EQUAL(plcl[c], plclm[c]);
+    ecape = fmax(ecape, fabs(cape[c] - capem[c]));
+    ecin = fmax(ecin, fabs(cin[c] - cinm[c]));
+    if (capem[c] > 100.0) {
+      CU_ASSERT_DOUBLE_EQUAL(cape[c], capem[c], 0.01*capem[c]);
+      CU_ASSERT_DOUBLE_EQUAL(cin[c], cinm[c], 0.05*fabs(cinm[c]) + 1.0);
+    }
+  }
+#ifdef VERBOSE
+  printf("max difference from %d levels: cape=%f cin=%f\n", m, ecape, ecin);
+#endif
+}
+
+int main(void) {
+  CU_pSuite s;
+
+  CU_initialize_registry();
+  s = CU_add_suite("parcel", NULL, NULL);
+  CU_add_test(s, "test_parcel_cape", test_parcel_cape);
+  CU_add_test(s, "test_parcel_newton", test_parcel_newton);
+  CU_add_test(s, "test_parcel_analytic", test_parcel_analytic);
+  CU_add_test(s, "test_parcel_refine", test_parcel_refine);
+  CU_basic_set_mode(CU_BRM_VERBOSE);
+  CU_basic_run_tests();
+  CU_cleanup_registry();
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <stdbool.h>
+#include <math.h>
+#include "remap.h"
+#include "bicubic_grid.h"
+
+const int nx = 30;
+const int ny = 19;
+double x[nx], y[ny];
+
+void test_remap_bicubic(void)
+{
+  const int n = 100;
+  const int nf = 2;
+  double xo[n], yo[n], fo[nf*n], fg[n];
+  double f[nf*nx*ny];
+  eno_remap_t *remap;
+  eno_bicubic_grid_t *grid;
+
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      f[j*nx+i] = 1.0 + 2.0*x[i] - 0.5*y[j] + 0.25*x[i]*y[j];
+      f[nx*ny+j*nx+i] = sin(x[i])*cos(y[j]);
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    xo[k] = x[0] + fmod(0.731*k, x[nx-1] - x[0]);
+    yo[k] = y[0] - fmod(0.317*k, y[0] - y[ny-1]);
+  }
+  remap = eno_remap_init_bicubic(nx, ny, x, y, n, xo, yo);
+  eno_remap_apply(remap, nf, f, fo);
+  grid = eno_bicubic_grid_init(nx, ny, x, y, true);
+  eno_bicubic_grid_set(grid, &f[nx*ny]);
+  eno_bicubic_grid_interpolate(grid, n, xo, yo, fg);
+  for (int k = 0; k < n; k++) {
+    CU_ASSERT_DOUBLE_EQUAL(fo[k], 1.0 + 2.0*xo[k] - 0.5*yo[k] + 0.25*xo[k]*yo[k], 1.0e-12);
+    CU_ASSERT_DOUBLE_EQUAL(fo[n+k], fg[k], 1.0e-13);
+  }
+  eno_bicubic_grid_clean(grid);
+  eno_remap_clean(remap);
+}
+
+void test_remap_biquadratic(void)
+{
+  const int n = 50;
+  double xo[n], yo[n], fo[n];
+  double f[nx*ny];
+  eno_remap_t *remap;
+
+  for (int j = 0; j < ny; j++) {
+    for (int i = 0; i < nx; i++) {
+      f[j*nx+i] = (1.0 + x[i] - 0.1*x[i]*x[i]) * (2.0 - y[j] + 0.3*y[j]*y[j]);
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    xo[k] = x[0] + fmod(1.37*k, x[nx-1] - x[0]);
+    yo[k] = y[0] - fmod(0.93*k, y[0] - y[ny-1]);
+  }
+  remap = eno_remap_init_biquadratic(nx, ny, x, y, n, xo, yo);
+  eno_remap_apply(remap, 1, f, fo);
+  for (int k = 0; k < n; k++) {
+    double g = (1.0 + xo[k] - 0.1*xo[k]*xo[k]) * (2.0 - yo[k] + 0.3*yo[k]*yo[k]);
+#ifdef VERBOSE
+    printf("x=%f y=%f f=%f g=%f\n", xo[k], yo[k], fo[k], g);
+#endif
+    CU_ASSERT_DOUBLE_EQUAL(fo[k], g, 1.0e-10);
+  }
+  eno_remap_clean(remap);
+}
+
+int main(void)
+{
+  CU_pSuite s;
+
+  for (int i = 0; i < nx; i++) {
+    x[i] = 0.5*i + 0.01*i*i;
+  }
+  for (int j = 0; j < ny; j++) {
+    y[j] = 9.0 - j;
+  }
+  CU_initialize_registry();
+  s = CU_add_suite("remap", NULL, NULL);
+  CU_add_test(s, "bicubic", test_remap_bicubic);
+  CU_add_test(s, "biquadratic", test_remap_biquadratic);
+  CU_basic_set_mode(CU_BRM_VERBOSE);
+  CU_basic_run_tests();
+  CU_cleanup_registry();
+
+  return 0;
+}
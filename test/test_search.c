@@ -1,5 +1,8 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
 #include "search.h"
 
 void test_search(void)
@@ -25,12 +28,122 @@ void test_search(void)
   CU_ASSERT_EQUAL(eno_search_bisection(y2, n, 1013.0),   4);
 }
 
+/// merge scan agrees with bisection for sorted, reversed and unsorted values
+void test_search_merge(void)
+{
+  const int n = 7;
+  const int m = 12;
+  double y1[n] = {1000.0, 925.0, 850.0, 700.0, 500.0, 300.0, 200.0};
+  double y2[n] = {200.0, 300.0, 500.0, 700.0, 850.0, 925.0, 1000.0};
+  double x[3][m] = {
+    {1013.0, 1000.0, 950.0, 925.0, 900.0, 850.0, 850.0, 600.0, 300.0, 250.0, 200.0, 100.0},
+    {100.0, 200.0, 250.0, 300.0, 600.0, 850.0, 850.0, 900.0, 925.0, 950.0, 1000.0, 1013.0},
+    {850.0, 100.0, 1013.0, 925.0, 300.0, 250.0, 1000.0, 200.0, 600.0, 950.0, 900.0, 850.0}
+  };
+  int idx[m];
+
+  for (int j = 0; j < 3; j++) {
+    eno_search_merge(y1, n, m, x[j], idx);
+    for (int l = 0; l < m; l++) {
+      CU_ASSERT_EQUAL(idx[l], eno_search_bisection(y1, n, x[j][l]));
+    }
+    eno_search_merge(y2, n, m, x[j], idx);
+    for (int l = 0; l < m; l++) {
+      CU_ASSERT_EQUAL(idx[l], eno_search_bisection(y2, n, x[j][l]));
+    }
+  }
+}
+
+/// Eytzinger layout agrees with bisection for any length and both directions
+void test_search_tree(void)
+{
+  const int m = 200;
+  double y[1000], x[m];
+  int idx[m];
+
+  for (int n = 1; n <= 1000; n += (n < 40) ? 1 : 191) {
+    for (int dir = 0; dir < 2; dir++) {
+      for (int j = 0; j < n; j++) {
+        y[j] = (dir == 0) ? 2.0*j : 2.0*(n-1-j);
+      }
+      for (int l = 0; l < m; l++) {
+        x[l] = (l % 3 == 0) ? (double)(rand() % (2*n+2) - 1) : 2.0*n*rand()/RAND_MAX - 1.0;
+      }
+      eno_search_tree_t *tree = eno_search_tree_init(y, n);
+      eno_search_tree_batch(tree, m, x, idx);
+      for (int l = 0; l < m; l++) {
+        int i = eno_search_bisection(y, n, x[l]);
+        CU_ASSERT_EQUAL(eno_search_tree(tree, x[l]), i);
+        CU_ASSERT_EQUAL(idx[l], i);
+      }
+      eno_search_tree_clean(tree);
+    }
+  }
+}
+
+/// bucket table agrees with linear search on uniform and stretched arrays
+void test_search_bucket(void)
+{
+  const int n = 64;
+  const int m = 500;
+  double y[3][n], x[m];
+  int idx[m];
+
+  for (int j = 0; j < n; j++) {
+    y[0][j] = 360.0*j/n;
+    y[1][j] = 90.0*cos(M_PI*(j+0.5)/n);
+    y[2][j] = pow((double)j/(n-1), 2.0)*1000.0;
+  }
+  for (int a = 0; a < 3; a++) {
+    double y0 = y[a][0], y1 = y[a][n-1];
+    for (int l = 0; l < m; l++) {
+      x[l] = (l % 5 == 0) ? y[a][l % n] : y0 + (y1 - y0)*(1.2*rand()/RAND_MAX - 0.1);
+    }
+    eno_search_bucket_t *bucket = eno_search_bucket_init(y[a], n, n);
+    eno_search_bucket_batch(bucket, m, x, idx);
+    for (int l = 0; l < m; l++) {
+      int i = eno_search_linear(y[a], n, x[l], 0);
+      CU_ASSERT_EQUAL(eno_search_bucket(bucket, x[l]), i);
+      CU_ASSERT_EQUAL(idx[l], i);
+    }
+    eno_search_bucket_clean(bucket);
+  }
+}
+
+/// lockstep bisection agrees with bisection in each column
+void test_search_column(void)
+{
+  const int n = 37;
+  const int ncol = 600;
+  double y[n*ncol], x[ncol], yc[n];
+  int idx[ncol];
+
+  for (int c = 0; c < ncol; c++) {
+    double ps = 100000.0 - 100.0*(c % 300);
+    for (int k = 0; k < n; k++) {
+      y[k*ncol+c] = (c % 2 == 0) ? ps*(k+0.5)/n : ps*(n-k-0.5)/n;
+    }
+    x[c] = (c % 7 == 0) ? y[(c % n)*ncol+c] : 110000.0*rand()/RAND_MAX - 1000.0;
+  }
+  eno_search_column(y, n, ncol, x, idx);
+  for (int c = 0; c < ncol; c++) {
+    for (int k = 0; k < n; k++) {
+      yc[k] = y[k*ncol+c];
+    }
+    CU_ASSERT_EQUAL(idx[c], eno_search_bisection(yc, n, x[c]));
+  }
+}
+
 int main(void) {
   CU_pSuite s;
 
   CU_initialize_registry();
   s = CU_add_suite("search", NULL, NULL);
   CU_add_test(s, "test_search", test_search);
+  CU_add_test(s, "test_search_merge", test_search_merge);
+  CU_add_test(s, "test_search_tree", test_search_tree);
+  CU_add_test(s, "test_search_bucket", test_search_bucket);
+  CU_add_test(s, "test_search_column", test_search_column);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
   CU_cleanup_registry();
@@ -0,0 +1,85 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <math.h>
+#include "earth.h"
+#include "sphere.h"
+#include "semilag.h"
+
+/// solid-body rotation about the z-axis on level 0 and the x-axis on level 1
+void test_semilag_rotation(void)
+{
+  const int nlon = 64;
+  const int nlat = 32;
+  const int nlev = 2;
+  const double speed = 40.0;
+  const double dt = 3600.0;
+  double axis[nlev][3] = {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}};
+  double lon[nlon], lat[nlat];
+  double u[nlev*nlat*nlon], v[nlev*nlat*nlon];
+  double lond[nlev*nlat*nlon], latd[nlev*nlat*nlon];
+  double omega = speed / eno_earth_radius;
+  double emax = 0.0;
+  eno_semilag_t *sl;
+
+  for (int i = 0; i < nlon; i++) {
+    lon[i] = 2.0*M_PI*i/nlon;
+  }
+  for (int j = 0; j < nlat; j++) {
+    lat[j] = 0.5*M_PI - (j+0.5)*M_PI/nlat;
+  }
+  for (int k = 0; k < nlev; k++) {
+    double *e = axis[k];
+    for (int j = 0; j < nlat; j++) {
+      for (int i = 0; i < nlon; i++) {
+        double r[3] = {cos(lat[j])*cos(lon[i]), cos(lat[j])*sin(lon[i]), sin(lat[j])};
+        double w[3] = {e[1]*r[2]-e[2]*r[1], e[2]*r[0]-e[0]*r[2], e[0]*r[1]-e[1]*r[0]};
+        u[(k*nlat+j)*nlon+i] = speed*(-sin(lon[i])*w[0] + cos(lon[i])*w[1]);
+        v[(k*nlat+j)*nlon+i] = speed*(-sin(lat[j])*(cos(lon[i])*w[0] + sin(lon[i])*w[1])
+                                      + cos(lat[j])*w[2]);
+      }
+    }
+  }
+  sl = eno_semilag_init(nlon, nlat, nlev, lon, lat, 3);
+  for (int step = 0; step < 2; step++) {
+    eno_semilag_departure(sl, dt, u, v, lond, latd);
+  }
+  for (int k = 0; k < nlev; k++) {
+    double *e = axis[k];
+    double c = cos(-omega*dt), s = sin(-omega*dt);
+    for (int j = 0; j < nlat; j++) {
+      for (int i = 0; i < nlon; i++) {
+        int l = (k*nlat+j)*nlon+i;
+        double r[3] = {cos(lat[j])*cos(lon[i]), cos(lat[j])*sin(lon[i]), sin(lat[j])};
+        double er = e[0]*r[0] + e[1]*r[1] + e[2]*r[2];
+        double exr[3] = {e[1]*r[2]-e[2]*r[1], e[2]*r[0]-e[0]*r[2], e[0]*r[1]-e[1]*r[0]};
+        double rd[3];
+        for (int m = 0; m < 3; m++) {
+          rd[m] = r[m]*c + exr[m]*s + e[m]*er*(1.0-c);
+        }
+        double d = eno_sphere_orthodrome(lond[l], 0.5*M_PI-latd[l],
+                                         atan2(rd[1], rd[0]), acos(rd[2]));
+        emax = fmax(emax, d);
+      }
+    }
+  }
+#ifdef VERBOSE
+  printf("max error=%e rad displacement=%e rad\n", emax, omega*dt);
+#endif
+  CU_ASSERT(emax < 1.0e-5);
+  eno_semilag_clean(sl);
+}
+
+int main(void)
+{
+  CU_pSuite s;
+
+  CU_initialize_registry();
+  s = CU_add_suite("semilag", NULL, NULL);
+  CU_add_test(s, "rotation", test_semilag_rotation);
+  CU_basic_set_mode(CU_BRM_VERBOSE);
+  CU_basic_run_tests();
+  CU_cleanup_registry();
+
+  return 0;
+}
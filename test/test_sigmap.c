@@ -1,7 +1,12 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
 #include "air.h"
 #include "earth.h"
+#include "moist.h"
+#include "emath.h"
 #include "sigmap.h"
 
 void test_sigmap(void)
@@ -59,12 +64,248 @@ void test_sigmap(void)
   eno_sigmap_clean(sigmap);
 }
 
+/// grid version agrees with eno_sigmap_calc_p() in both layouts
+void test_sigmap_grid(void)
+{
+  const int n = 10;
+  const int ncol = 300;
+  const double ptop = 50.0;
+  double a[n+1], b[n+1], ps[ncol];
+  double ph[n+1], dp[n+1], pf[n+1];
+  double phg[(n+1)*ncol], dpg[(n+1)*ncol], pfg[(n+1)*ncol];
+  double phc[(n+1)*ncol], dpc[(n+1)*ncol], pfc[(n+1)*ncol];
+  eno_sigmap_t *sigmap;
+
+  for (int k = 0; k < n+1; k++) {
+    b[k] = pow((double)k/n, 2.0);
+    a[k] = ptop + 20000.0*((double)k/n - b[k]);
+  }
+  for (int c = 0; c < ncol; c++) {
+    ps[c] = 100000.0 - 50.0*c;
+  }
+  sigmap = eno_sigmap_init(n, a, b, ptop);
+  CU_ASSERT_EQUAL(eno_sigmap_calc_p_grid(sigmap, ncol, ps, SIGMAP_LEVEL_MAJOR, phg, dpg, pfg), 0);
+  CU_ASSERT_EQUAL(eno_sigmap_calc_p_grid(sigmap, ncol, ps, SIGMAP_COLUMN_MAJOR, phc, dpc, pfc), 0);
+  CU_ASSERT_EQUAL(eno_sigmap_calc_p_grid(sigmap, ncol, ps, 2, phc, dpc, pfc), -1);
+  for (int c = 0; c < ncol; c++) {
+    eno_sigmap_calc_p(sigmap, ps[c], ph, dp, pf);
+    for (int k = 0; k < n+1; k++) {
+      CU_ASSERT_EQUAL(phg[k*ncol+c], ph[k]);
+      CU_ASSERT_EQUAL(phc[c*(n+1)+k], ph[k]);
+    }
+    for (int k = 1; k < n+1; k++) {
+      CU_ASSERT_DOUBLE_EQUAL(dpg[k*ncol+c], dp[k], 1.0e-9);
+      CU_ASSERT_DOUBLE_EQUAL(dpc[c*(n+1)+k], dp[k], 1.0e-9);
+      CU_ASSERT_EQUAL(pfg[k*ncol+c], pf[k]);
+      CU_ASSERT_EQUAL(pfc[c*(n+1)+k], pf[k]);
+    }
+  }
+  eno_sigmap_calc_p_grid(sigmap, ncol, ps, SIGMAP_LEVEL_MAJOR, phg, NULL, NULL);
+  CU_ASSERT_EQUAL(phg[n*ncol+7], ps[7]);
+  eno_sigmap_clean(sigmap);
+}
+
+/// fused geopotential agrees with the chain of single-column functions
+void test_sigmap_gz_grid(void)
+{
+  const int n = 10;
+  const int ncol = 300;
+  const double ptop = 50.0;
+  double a[n+1], b[n+1], ps[ncol], gzs[ncol];
+  double ph[n+1], dp[n+1], pf[n+1], alpha[n+1], beta[n+1], Tv[n+1], gz[n+1];
+  double T[(n+1)*ncol], q[(n+1)*ncol], gzg[(n+1)*ncol];
+  eno_sigmap_t *sigmap;
+
+  for (int k = 0; k < n+1; k++) {
+    b[k] = pow((double)k/n, 2.0);
+    a[k] = ptop + 20000.0*((double)k/n - b[k]);
+  }
+  for (int c = 0; c < ncol; c++) {
+    ps[c] = 100000.0 - 50.0*c;
+    gzs[c] = 10.0*c;
+    for (int k = 1; k < n+1; k++) {
+      T[k*ncol+c] = 200.0 + 8.0*k + 0.01*c;
+      q[k*ncol+c] = 1.0e-3*k*(1.0 + 0.001*c);
+    }
+  }
+  sigmap = eno_sigmap_init(n, a, b, ptop);
+  eno_sigmap_calc_gz_grid(sigmap, ncol, ps, gzs, T, q, gzg);
+  for (int c = 0; c < ncol; c++) {
+    for (int k = 1; k < n+1; k++) {
+      Tv[k] = eno_moist_calc_Tv(T[k*ncol+c], q[k*ncol+c]);
+    }
+    eno_sigmap_calc_p(sigmap, ps[c], ph, dp, pf);
+    eno_sigmap_calc_alphabeta(sigmap, ph, dp, alpha, beta);
+    eno_sigmap_calc_gz(sigmap, gzs[c], alpha, beta, Tv, gz);
+    for (int k = 1; k < n+1; k++) {
+      CU_ASSERT_DOUBLE_EQUAL(gzg[k*ncol+c], gz[k], 1.0e-8*gz[k]);
+    }
+  }
+  eno_sigmap_clean(sigmap);
+}
+
+/// borrowed coefficients and caller's workspace give the same geopotential
+void test_sigmap_borrow(void)
+{
+  const int n = 10;
+  const double ptop = 50.0;
+  const double ps = 95000.0;
+  const double gzs = 500.0;
+  double a[n+1], b[n+1], db[n+1], T[n+1], q[n+1], gz[n+1], gzb[n+1];
+  double ph[n+1], dp[n+1], pf[n+1], alpha[n+1], beta[n+1], Tv[n+1];
+  eno_sigmap_t sb, *sigmap;
+
+  for (int k = 0; k < n+1; k++) {
+    b[k] = pow((double)k/n, 2.0);
+    a[k] = ptop + 20000.0*((double)k/n - b[k]);
+    T[k] = 200.0 + 8.0*k;
+    q[k] = 1.0e-3*k;
+  }
+  sigmap = eno_sigmap_init(n, a, b, ptop);
+  eno_sigmap_init_borrow(&sb, n, a, b, db, ptop);
+  CU_ASSERT(sb.a == a && sb.b == b && sb.db == db);
+  for (int k = 1; k < n+1; k++) {
+    CU_ASSERT_EQUAL(db[k], sigmap->db[k]);
+    Tv[k] = eno_moist_calc_Tv(T[k], q[k]);
+  }
+  CU_ASSERT_EQUAL(eno_sigmap_work_size(&sb), 6*(n+1));
+  double work[eno_sigmap_work_size(&sb)];
+  eno_sigmap_calc_column(&sb, ps, gzs, T, q, work, gzb);
+  eno_sigmap_calc_p(sigmap, ps, ph, dp, pf);
+  eno_sigmap_calc_alphabeta(sigmap, ph, dp, alpha, beta);
+  eno_sigmap_calc_gz(sigmap, gzs, alpha, beta, Tv, gz);
+  for (int k = 1; k < n+1; k++) {
+    CU_ASSERT_EQUAL(gzb[k], gz[k]);
+    CU_ASSERT_EQUAL(work[2*(n+1)+k], pf[k]);
+  }
+  eno_sigmap_clean(&sb);
+  eno_sigmap_clean(sigmap);
+}
+
+/// vectorized alpha and beta agree with eno_sigmap_calc_alphabeta()
+void test_sigmap_alphabeta_grid(void)
+{
+  const int n = 10;
+  const int ncol = 300;
+  const double ptop = 50.0;
+  double a[n+1], b[n+1], ps[ncol];
+  double ph[n+1], dp[n+1], pf[n+1], alpha[n+1], beta[n+1];
+  double phg[(n+1)*ncol], dpg[(n+1)*ncol];
+  double alphag[(n+1)*ncol], betag[(n+1)*ncol], alphaf[(n+1)*ncol], betaf[(n+1)*ncol];
+  eno_sigmap_t *sigmap;
+
+  for (int k = 0; k < n+1; k++) {
+    b[k] = pow((double)k/n, 2.0);
+    a[k] = ptop + 20000.0*((double)k/n - b[k]);
+  }
+  for (int c = 0; c < ncol; c++) {
+    ps[c] = 100000.0 - 50.0*c;
+  }
+  sigmap = eno_sigmap_init(n, a, b, ptop);
+  eno_sigmap_calc_p_grid(sigmap, ncol, ps, SIGMAP_LEVEL_MAJOR, phg, dpg, NULL);
+  eno_sigmap_calc_alphabeta_grid(sigmap, ncol, phg, dpg, ELOG_FULL, alphag, betag);
+  eno_sigmap_calc_alphabeta_grid(sigmap, ncol, phg, dpg, ELOG_FAST, alphaf, betaf);
+  for (int c = 0; c < ncol; c++) {
+    eno_sigmap_calc_p(sigmap, ps[c], ph, dp, pf);
+    eno_sigmap_calc_alphabeta(sigmap, ph, dp, alpha, beta);
+    CU_ASSERT_EQUAL(alphag[ncol+c], alpha[1]);
+    for (int k = 2; k < n+1; k++) {
+      CU_ASSERT_DOUBLE_EQUAL(betag[k*ncol+c], beta[k], 1.0e-15*beta[k]);
+      CU_ASSERT_DOUBLE_EQUAL(alphag[k*ncol+c], alpha[k], 1.0e-13);
+      CU_ASSERT_DOUBLE_EQUAL(betaf[k*ncol+c], beta[k], 1.0e-10*beta[k]);
+      CU_ASSERT_DOUBLE_EQUAL(alphaf[k*ncol+c], alpha[k], 1.0e-9);
+    }
+  }
+  eno_sigmap_clean(sigmap);
+}
+
+/// sigma coordinates: exact isothermal pressure gradient and omega of uniform divergence
+void test_sigmap_omega_grid(void)
+{
+  const int n = 10;
+  const int ncol = 300;
+  const double Rd = eno_air_Rd;
+  const double T0 = 250.0;
+  const double d0 = 1.0e-5;
+  double a[n+1], b[n+1], ps[ncol], dpsdx[ncol], dpsdy[ncol], dpsdt[ncol];
+  double ph[(n+1)*ncol], dp[(n+1)*ncol], pf[(n+1)*ncol];
+  double alpha[(n+1)*ncol], beta[(n+1)*ncol], Tv[(n+1)*ncol];
+  double u[(n+1)*ncol], v[(n+1)*ncol], d[(n+1)*ncol];
+  double px[(n+1)*ncol], py[(n+1)*ncol], etadot[(n+1)*ncol], omega[(n+1)*ncol];
+  eno_sigmap_t *sigmap;
+
+  for (int k = 0; k < n+1; k++) {
+    a[k] = 0.0;
+    b[k] = pow((double)k/n, 2.0);
+  }
+  for (int c = 0; c < ncol; c++) {
+    ps[c] = 100000.0 - 50.0*c;
+    dpsdx[c] = 1.0e-3*c;
+    dpsdy[c] = -2.0e-3;
+  }
+  for (int i = 0; i < (n+1)*ncol; i++) {
+    Tv[i] = T0;
+    u[i] = 10.0;
+    v[i] = -5.0;
+    d[i] = d0;
+  }
+  sigmap = eno_sigmap_init(n, a, b, 0.0);
+  eno_sigmap_calc_p_grid(sigmap, ncol, ps, SIGMAP_LEVEL_MAJOR, ph, dp, pf);
+  eno_sigmap_calc_alphabeta_grid(sigmap, ncol, ph, dp, ELOG_FULL, alpha, beta);
+  eno_sigmap_calc_pgf_grid(sigmap, ncol, dp, alpha, beta, Tv, dpsdx, dpsdy, px, py);
+  for (int c = 0; c < ncol; c++) {
+    double r = Rd*T0/ps[c];
+    CU_ASSERT_DOUBLE_EQUAL(px[ncol+c], log(2.0)*r*dpsdx[c], 1.0e-14);
+    for (int k = 2; k < n+1; k++) {
+      CU_ASSERT_DOUBLE_EQUAL(px[k*ncol+c], r*dpsdx[c], 1.0e-14);
+      CU_ASSERT_DOUBLE_EQUAL(py[k*ncol+c], r*dpsdy[c], 1.0e-14);
+    }
+  }
+// mass is conserved and the bottom is a material surface
+  eno_sigmap_calc_omega_grid(sigmap, ncol, dp, pf, alpha, beta, u, v, d,
+    dpsdx, dpsdy, dpsdt, etadot, omega);
+  for (int c = 0; c < ncol; c++) {
+    double vgp = u[c]*dpsdx[c] + v[c]*dpsdy[c];
+    CU_ASSERT_DOUBLE_EQUAL(dpsdt[c], -d0*ps[c] - vgp, 1.0e-12);
+    CU_ASSERT_EQUAL(etadot[c], 0.0);
+    CU_ASSERT_DOUBLE_EQUAL(etadot[n*ncol+c], 0.0, 1.0e-12);
+  }
+// uniform divergence on a flat surface does not cross sigma surfaces
+  for (int c = 0; c < ncol; c++) {
+    dpsdx[c] = 0.0;
+    dpsdy[c] = 0.0;
+  }
+  eno_sigmap_calc_omega_grid(sigmap, ncol, dp, pf, alpha, beta, u, v, d,
+    dpsdx, dpsdy, dpsdt, etadot, omega);
+  for (int c = 0; c < ncol; c++) {
+    CU_ASSERT_DOUBLE_EQUAL(dpsdt[c], -d0*ps[c], 1.0e-12);
+    CU_ASSERT_DOUBLE_EQUAL(omega[ncol+c], -log(2.0)*d0*pf[ncol+c], 1.0e-12);
+    for (int k = 1; k < n+1; k++) {
+      CU_ASSERT_DOUBLE_EQUAL(etadot[k*ncol+c], 0.0, 1.0e-12);
+    }
+    for (int k = 2; k < n+1; k++) {
+      CU_ASSERT_DOUBLE_EQUAL(omega[k*ncol+c], -d0*pf[k*ncol+c], 1.0e-12);
+    }
+  }
+  eno_sigmap_calc_omega_grid(sigmap, ncol, dp, pf, alpha, beta, u, v, d,
+    dpsdx, dpsdy, ps, NULL, NULL);
+  for (int c = 0; c < ncol; c++) {
+    CU_ASSERT_EQUAL(ps[c], dpsdt[c]);
+  }
+  eno_sigmap_clean(sigmap);
+}
+
 int main(void) {
   CU_pSuite s;
 
   CU_initialize_registry();
   s = CU_add_suite("sigmap", NULL, NULL);
   CU_add_test(s, "test_calc_z", test_sigmap);
+  CU_add_test(s, "test_calc_p_grid", test_sigmap_grid);
+  CU_add_test(s, "test_calc_gz_grid", test_sigmap_gz_grid);
+  CU_add_test(s, "test_borrow", test_sigmap_borrow);
+  CU_add_test(s, "test_calc_alphabeta_grid", test_sigmap_alphabeta_grid);
+  CU_add_test(s, "test_calc_omega_grid", test_sigmap_omega_grid);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
   CU_cleanup_registry();
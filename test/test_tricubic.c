@@ -0,0 +1,157 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include "tricubic.h"
+
+const int nx = 12;
+const int ny = 9;
+const int nz = 7;
+double x[nx], y[ny], z[nz], f[nx*ny*nz];
+
+/// cubic in each direction, reproduced by Lagrange
+double cubic(double xp, double yp, double zp)
+{
+  return 1.0 + xp*(0.5 - 0.02*xp*xp) + yp*yp*(0.3 + 0.01*yp) - 1.0e-3*zp*zp*zp + 0.1*xp*yp*zp;
+}
+
+/// quadratic in x and y, linear in z, reproduced by Hermite away from the edges
+double quadratic(double xp, double yp, double zp)
+{
+  return 1.0 + xp*(0.5 - 0.1*xp) - 0.2*yp*yp + 0.3*zp + 0.05*xp*yp;
+}
+
+void test_tricubic_lagrange(void)
+{
+  const int n = 20;
+  double xo[n], yo[n], zo[n], fo[n], wx[4*n], wy[4*n], wz[4*n];
+  int ix[n], iy[n], iz[n];
+
+  for (int k = 0; k < nz; k++) {
+    for (int j = 0; j < ny; j++) {
+      for (int i = 0; i < nx; i++) {
+        f[(k*ny+j)*nx+i] = cubic(x[i], y[j], z[k]);
+      }
+    }
+  }
+  for (int l = 0; l < n; l++) {
+    xo[l] = fmod(1.37*l, 11.0);
+    yo[l] = 4.0 - fmod(0.83*l, 8.0);
+    zo[l] = 1.0 - 0.999*l/(n-1);
+  }
+  eno_tricubic_axis_lagrange(nx, x, n, xo, ix, wx);
+  eno_tricubic_axis_lagrange(ny, y, n, yo, iy, wy);
+  eno_tricubic_axis_lagrange(nz, z, n, zo, iz, wz);
+  eno_tricubic_interpolate(nx, ny, nz, f, false, n, ix, wx, iy, wy, iz, wz, fo);
+  for (int l = 0; l < n; l++) {
+#ifdef VERBOSE
+    printf("x=%f y=%f z=%f f=%f %f\n", xo[l], yo[l], zo[l], fo[l], cubic(xo[l], yo[l], zo[l]));
+#endif
+    CU_ASSERT_DOUBLE_EQUAL(fo[l], cubic(xo[l], yo[l], zo[l]), 1.0e-11);
+  }
+}
+
+void test_tricubic_hermite(void)
+{
+  const int mx = 5;
+  const int my = 4;
+  const int mz = 6;
+  double xo[mx] = {1.0, 2.5, 5.25, 8.9, 9.99};
+  double yo[my] = {-2.9, -0.5, 1.1, 2.0};
+  double zo[mz] = {0.7, 0.6, 0.45, 0.3, 0.2, 0.1};
+  double fo[mz*my*mx], wx[4*mx], wy[4*my], wz[4*mz];
+  int ix[mx], iy[my], iz[mz];
+
+  for (int k = 0; k < nz; k++) {
+    for (int j = 0; j < ny; j++) {
+      for (int i = 0; i < nx; i++) {
+        f[(k*ny+j)*nx+i] = quadratic(x[i], y[j], z[k]);
+      }
+    }
+  }
+  eno_tricubic_axis_hermite(nx, x, mx, xo, ix, wx);
+  eno_tricubic_axis_hermite(ny, y, my, yo, iy, wy);
+  eno_tricubic_axis_hermite(nz, z, mz, zo, iz, wz);
+  eno_tricubic_interpolate_grid(nx, ny, nz, f, false, mx, ix, wx, my, iy, wy, mz, iz, wz, fo);
+  for (int k = 0; k < mz; k++) {
+    for (int j = 0; j < my; j++) {
+      for (int i = 0; i < mx; i++) {
+        CU_ASSERT_DOUBLE_EQUAL(fo[(k*my+j)*mx+i], quadratic(xo[i], yo[j], zo[k]), 1.0e-12);
+      }
+    }
+  }
+
+// weights at the edges are one-sided and sum to one
+  double xe[2] = {0.2, 10.8}, we[8];
+  int ie[2];
+  eno_tricubic_axis_hermite(nx, x, 2, xe, ie, we);
+  CU_ASSERT_EQUAL(ie[0], 0);
+  CU_ASSERT_EQUAL(ie[1], nx-2);
+  CU_ASSERT_DOUBLE_EQUAL(we[0]+we[1]+we[2]+we[3], 1.0, 1.0e-15);
+  CU_ASSERT_DOUBLE_EQUAL(we[4]+we[5]+we[6]+we[7], 1.0, 1.0e-15);
+  CU_ASSERT_DOUBLE_EQUAL(we[3], 0.0, 1.0e-15);
+  CU_ASSERT_DOUBLE_EQUAL(we[4], 0.0, 1.0e-15);
+}
+
+/// a positive step stays within the values of each cell
+void test_tricubic_mono(void)
+{
+  const int n = 50;
+  double xo[n], yo[n], zo[n], fo[n], fm[n], wx[4*n], wy[4*n], wz[4*n];
+  int ix[n], iy[n], iz[n];
+
+  for (int k = 0; k < nz; k++) {
+    for (int j = 0; j < ny; j++) {
+      for (int i = 0; i < nx; i++) {
+        f[(k*ny+j)*nx+i] = (x[i] > 5.5 && z[k] < 0.5) ? 1.0 : 0.0;
+      }
+    }
+  }
+  for (int l = 0; l < n; l++) {
+    xo[l] = 3.0 + 0.11*l;
+    yo[l] = 1.3;
+    zo[l] = 0.1 + 0.014*l;
+  }
+  eno_tricubic_axis_lagrange(nx, x, n, xo, ix, wx);
+  eno_tricubic_axis_lagrange(ny, y, n, yo, iy, wy);
+  eno_tricubic_axis_lagrange(nz, z, n, zo, iz, wz);
+  eno_tricubic_interpolate(nx, ny, nz, f, false, n, ix, wx, iy, wy, iz, wz, fo);
+  eno_tricubic_interpolate(nx, ny, nz, f, true, n, ix, wx, iy, wy, iz, wz, fm);
+  double lo = 0.0, hi = 0.0;
+  for (int l = 0; l < n; l++) {
+    lo = fmin(lo, fo[l]);
+    hi = fmax(hi, fo[l]);
+    CU_ASSERT(fm[l] >= 0.0 && fm[l] <= 1.0);
+  }
+#ifdef VERBOSE
+  printf("unlimited range %f %f\n", lo, hi);
+#endif
+  CU_ASSERT(lo < 0.0);
+}
+
+int main(void)
+{
+  CU_pSuite s;
+
+  for (int i = 0; i < nx; i++) {
+    x[i] = i;
+  }
+  for (int j = 0; j < ny; j++) {
+    y[j] = 4.0 - j;
+  }
+// sigma-like levels from the top
+  for (int k = 0; k < nz; k++) {
+    z[k] = pow((k + 0.5) / nz, 1.5);
+  }
+  CU_initialize_registry();
+  s = CU_add_suite("tricubic", NULL, NULL);
+  CU_add_test(s, "lagrange", test_tricubic_lagrange);
+  CU_add_test(s, "hermite", test_tricubic_hermite);
+  CU_add_test(s, "mono", test_tricubic_mono);
+  CU_basic_set_mode(CU_BRM_VERBOSE);
+  CU_basic_run_tests();
+  CU_cleanup_registry();
+
+  return 0;
+}
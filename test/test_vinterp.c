@@ -0,0 +1,132 @@
+#include <CUnit/CUnit.h>
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include "air.h"
+#include "isa.h"
+#include "extrapolate.h"
+#include "vinterp.h"
+
+const int n = 20;
+const int ncol = 300;
+const double ptop = 100.0;
+double a[n+1], b[n+1], ps[ncol], zs[ncol];
+double ph[n+1], dp[n+1], pf[n+1];
+
+/// cubic in ln p, interpolated exactly
+double cubic(double lnp)
+{
+  double x = lnp - 10.0;
+  return 1.0 + x*(0.5 + x*(-0.2 + 0.05*x));
+}
+
+void test_vinterp_p(void)
+{
+  const int nf = 3;
+  const int np = 6;
+  int kind[nf] = {VINTERP_T, VINTERP_Z, VINTERP_OTHER};
+  double plev[np] = {50.0, 500.0, 30000.0, 85000.0, 99000.0, 105000.0};
+  double f[nf*n*ncol], fo[nf*np*ncol];
+  eno_vinterp_t *vi = eno_vinterp_init(n, a, b, ptop);
+
+  for (int c = 0; c < ncol; c++) {
+    eno_sigmap_calc_p(vi->sigmap, ps[c], ph, dp, pf);
+    for (int k = 0; k < n; k++) {
+      double lnp = log(pf[k+1]);
+      f[(0*n+k)*ncol+c] = 200.0 + 10.0*lnp;
+      f[(1*n+k)*ncol+c] = zs[c] - 8000.0*log(pf[k+1]/ps[c]);
+      f[(2*n+k)*ncol+c] = cubic(lnp);
+    }
+  }
+  eno_vinterp_p(vi, ncol, ps, zs, nf, kind, f, np, plev, fo);
+  for (int c = 0; c < ncol; c++) {
+    eno_sigmap_calc_p(vi->sigmap, ps[c], ph, dp, pf);
+    double Tn = f[(0*n+n-1)*ncol+c];
+    double zn = f[(1*n+n-1)*ncol+c];
+    double Ts = eno_extrapolate_Ts(Tn, pf[n]/ps[c]);
+    for (int l = 0; l < np; l++) {
+      double lnp = log(plev[l]);
+      double *T = &fo[(0*np+l)*ncol+c];
+      double *z = &fo[(1*np+l)*ncol+c];
+      double *q = &fo[(2*np+l)*ncol+c];
+      if (plev[l] < pf[1]) {
+        CU_ASSERT_EQUAL(*q, f[(2*n)*ncol+c]);
+      } else if (plev[l] < pf[n]) {
+        CU_ASSERT_DOUBLE_EQUAL(*T, 200.0 + 10.0*lnp, 1.0e-10);
+        CU_ASSERT_DOUBLE_EQUAL(*z, zs[c] - 8000.0*log(plev[l]/ps[c]), 1.0e-8);
+        CU_ASSERT_DOUBLE_EQUAL(*q, cubic(lnp), 1.0e-10);
+      } else if (plev[l] <= ps[c]) {
+        double t = (lnp - log(pf[n])) / (log(ps[c]) - log(pf[n]));
+        CU_ASSERT_DOUBLE_EQUAL(*T, Tn + t*(Ts - Tn), 1.0e-10);
+        CU_ASSERT_DOUBLE_EQUAL(*z, zn + t*(zs[c] - zn), 1.0e-8);
+        CU_ASSERT_EQUAL(*q, f[(2*n+n-1)*ncol+c]);
+      } else {
+        CU_ASSERT_DOUBLE_EQUAL(*T, eno_extrapolate_T(zs[c], Ts, plev[l]/ps[c]), 1.0e-10);
+        CU_ASSERT_DOUBLE_EQUAL(*z, eno_extrapolate_z(zs[c], Ts, plev[l]/ps[c]), 1.0e-8);
+        CU_ASSERT(*z < zs[c]);
+        CU_ASSERT_EQUAL(*q, f[(2*n+n-1)*ncol+c]);
+      }
+    }
+  }
+  eno_vinterp_clean(vi);
+}
+
+void test_vinterp_z(void)
+{
+  const int nf = 2;
+  const int nz = 4;
+  int kind[nf] = {VINTERP_T, VINTERP_OTHER};
+  double zlev[nz] = {20000.0, 5000.0, 1000.0, 0.0};
+  double z[n*ncol], f[nf*n*ncol], fo[nf*nz*ncol];
+  eno_vinterp_t *vi = eno_vinterp_init(n, a, b, ptop);
+
+  for (int c = 0; c < ncol; c++) {
+    eno_sigmap_calc_p(vi->sigmap, ps[c], ph, dp, pf);
+    for (int k = 0; k < n; k++) {
+      z[k*ncol+c] = zs[c] - 8000.0*log(pf[k+1]/ps[c]);
+      f[(0*n+k)*ncol+c] = 288.0 - 0.0065*z[k*ncol+c];
+      f[(1*n+k)*ncol+c] = cubic(z[k*ncol+c]*1.0e-3);
+    }
+  }
+  eno_vinterp_z(vi, ncol, ps, zs, z, nf, kind, f, nz, zlev, fo);
+  for (int c = 0; c < ncol; c++) {
+    eno_sigmap_calc_p(vi->sigmap, ps[c], ph, dp, pf);
+    double Ts = eno_extrapolate_Ts(f[(n-1)*ncol+c], pf[n]/ps[c]);
+    for (int l = 0; l < nz; l++) {
+      double T = fo[l*ncol+c];
+      double q = fo[(nz+l)*ncol+c];
+      if (zlev[l] > z[(n-1)*ncol+c]) {
+        CU_ASSERT_DOUBLE_EQUAL(T, 288.0 - 0.0065*zlev[l], 1.0e-10);
+        CU_ASSERT_DOUBLE_EQUAL(q, cubic(zlev[l]*1.0e-3), 1.0e-10);
+      } else if (zlev[l] < zs[c]) {
+        CU_ASSERT_DOUBLE_EQUAL(T, Ts + eno_isa_dTdz(0)*(zlev[l] - zs[c]), 1.0e-10);
+        CU_ASSERT_EQUAL(q, f[(n+n-1)*ncol+c]);
+      }
+    }
+  }
+  eno_vinterp_clean(vi);
+}
+
+int main(void)
+{
+  CU_pSuite s;
+
+  for (int k = 0; k < n+1; k++) {
+    b[k] = pow((double)k/n, 1.5);
+    a[k] = ptop;
+  }
+  for (int c = 0; c < ncol; c++) {
+    zs[c] = 1500.0*(1.0 + sin(0.05*c));
+    ps[c] = 101300.0*exp(-zs[c]/8000.0);
+  }
+  CU_initialize_registry();
+  s = CU_add_suite("vinterp", NULL, NULL);
+  CU_add_test(s, "p", test_vinterp_p);
+  CU_add_test(s, "z", test_vinterp_z);
+  CU_basic_set_mode(CU_BRM_VERBOSE);
+  CU_basic_run_tests();
+  CU_cleanup_registry();
+
+  return 0;
+}
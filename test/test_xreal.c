@@ -1,6 +1,9 @@
 #include <CUnit/CUnit.h>
 #include <CUnit/Basic.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <stdbool.h>
 #include "xreal.h"
 
@@ -77,12 +80,103 @@ void  test_xreal()
   CU_ASSERT_EQUAL(eno_xreal_le(z, y), false);
 }
 
+void test_xreal_base10_array()
+{
+  const int n = 6;
+  eno_xreal_table_t *tab;
+  xreal_t x[n], y[n], z[n], w;
+  FILE *fp;
+
+  tab = eno_xreal_table_init(4);
+  eno_xreal_assign_f(3.0e100, &x[0]);
+  eno_xreal_ipow(x[0], 5, &x[1]);
+  eno_xreal_ipow(x[0], -7, &x[2]);
+  eno_xreal_ipow(x[0], 50, &x[3]);
+  eno_xreal_fx(-1.0, x[1], &x[4]);
+  eno_xreal_assign_f(0.0, &x[5]);
+
+  eno_xreal_base10_array(tab, n, x, y);
+  for (int j = 0; j < n - 1; j++) {
+    eno_xreal_base10(x[j], &w);
+#ifdef VERBOSE
+    printf("%.16f %d %.16f %d\n", y[j].p, y[j].i, w.p, w.i);
+#endif
+    CU_ASSERT(fabs(y[j].p) >= 1.0 && fabs(y[j].p) < 10.0);
+    CU_ASSERT_DOUBLE_EQUAL(y[j].p * pow(10.0, y[j].i - w.i), w.p, 1.0e-12*fabs(w.p));
+  }
+  CU_ASSERT_EQUAL(y[0].i, 100);
+  CU_ASSERT_EQUAL(y[1].i, 502);
+  CU_ASSERT_EQUAL(y[3].i, 5023);
+  CU_ASSERT_EQUAL(y[5].p, 0.0);
+
+  eno_xreal_from_base10_array(tab, n, y, z);
+  for (int j = 0; j < n; j++) {
+    CU_ASSERT_EQUAL(z[j].i, x[j].i);
+    CU_ASSERT_DOUBLE_EQUAL(z[j].p, x[j].p, 2.0e-15*fabs(x[j].p));
+  }
+
+  fp = tmpfile();
+  CU_ASSERT_EQUAL(eno_xreal_write_text(tab, fp, n, x), n);
+  rewind(fp);
+  CU_ASSERT_EQUAL(eno_xreal_read_text(tab, fp, n, z), n);
+  fclose(fp);
+  for (int j = 0; j < n; j++) {
+    CU_ASSERT_EQUAL(z[j].i, x[j].i);
+    CU_ASSERT_DOUBLE_EQUAL(z[j].p, x[j].p, 2.0e-15*fabs(x[j].p));
+  }
+
+  fp = tmpfile();
+  CU_ASSERT_EQUAL(eno_xreal_write_binary(tab, fp, n, x), n);
+  rewind(fp);
+  CU_ASSERT_EQUAL(eno_xreal_read_binary(tab, fp, n, z), n);
+  fclose(fp);
+  for (int j = 0; j < n; j++) {
+    CU_ASSERT_EQUAL(z[j].i, x[j].i);
+    CU_ASSERT_DOUBLE_EQUAL(z[j].p, x[j].p, 2.0e-15*fabs(x[j].p));
+  }
+  eno_xreal_table_clean(tab);
+}
+
+/// binary records have a fixed layout and the same data give identical bytes
+void test_xreal_binary_layout()
+{
+  const int n = 300;
+  eno_xreal_table_t *tab;
+  xreal_t x[n];
+  unsigned char b1[n*XREC], b2[n*XREC];
+  const unsigned char one[XREC] = {0, 0, 0, 0, 0, 0, 0xf0, 0x3f, 0, 0, 0, 0};
+  FILE *fp;
+
+  tab = eno_xreal_table_init(4);
+  eno_xreal_assign_f(1.0, &x[0]);
+  for (int j = 1; j < n; j++) {
+    eno_xreal_assign_f(-1.7e-3*j, &x[j]);
+    eno_xreal_ipow(x[j], j, &x[j]);
+  }
+  fp = tmpfile();
+  CU_ASSERT_EQUAL(eno_xreal_write_binary(tab, fp, n, x), n);
+  CU_ASSERT_EQUAL(ftell(fp), n*XREC);
+  rewind(fp);
+  CU_ASSERT_EQUAL(fread(b1, 1, n*XREC, fp), n*XREC);
+  fclose(fp);
+  fp = tmpfile();
+  CU_ASSERT_EQUAL(eno_xreal_write_binary(tab, fp, n, x), n);
+  rewind(fp);
+  CU_ASSERT_EQUAL(fread(b2, 1, n*XREC, fp), n*XREC);
+  fclose(fp);
+  CU_ASSERT_EQUAL(memcmp(b1, b2, n*XREC), 0);
+  CU_ASSERT_EQUAL(memcmp(b1, one, XREC), 0);
+  eno_xreal_table_clean(tab);
+}
+
 int main(void) {
   CU_pSuite s;
 
   CU_initialize_registry();
   s = CU_add_suite("xreal", NULL, NULL);
   CU_add_test(s, "test", test_xreal);
+  CU_add_test(s, "base10_array", test_xreal_base10_array);
+  CU_add_test(s, "binary_layout", test_xreal_binary_layout);
   CU_basic_set_mode(CU_BRM_VERBOSE);
   CU_basic_run_tests();
   CU_cleanup_registry();
@@ -0,0 +1,190 @@
+/// Tricubic interpolation
+/**
+ * @file tricubic.c
+ * @author Takeshi Enomoto
+ *
+ * # Algorithm
+ *
+ * Both tricubic Hermite and 4x4x4 Lagrange interpolation are tensor products
+ * of 1-D weights on the nodes \f$i-1,\dots,i+2\f$ of each axis
+ * \f[
+ * f(x,y,z) = \sum_{c=0}^{3}w^z_c\sum_{b=0}^{3}w^y_b\sum_{a=0}^{3}w^x_a f_{i-1+a,j-1+b,k-1+c}
+ * \f]
+ * so that a point needs 12 weights instead of 64 coefficients.
+ * The weights of each axis are computed separately by
+ * eno_tricubic_axis_lagrange() or eno_tricubic_axis_hermite(),
+ * which locate the targets with eno_search_linear() starting from the previous
+ * cell, and accept non-uniform, ascending or descending axes such as model levels.
+ *
+ * Lagrange weights are given by eno_cubic_lagrange_weights().
+ * Hermite weights are given by eno_cubic_hermite_weights(), which reproduce
+ * eno_bicubic_grid_interpolate() in two dimensions.
+ * Near the boundaries the Lagrange stencil is shifted inside
+ * and the Hermite derivatives become one-sided.
+ * The axis functions return the cell \f$i\f$ containing the target and the stencil
+ * starts at \f$\max(0,\min(n-4,i-1))\f$.
+ *
+ * Optionally the interpolated value is limited to the range of the 8 nodes
+ * of the cell containing the point (quasi-monotone, Bermejo and Staniforth 1992).
+ * The bounds are gathered while summing the stencil, so that positive-definite
+ * fields such as moisture stay bounded without another pass over the output.
+ *
+ * eno_tricubic_interpolate() evaluates scattered points with the weights
+ * of each point, while eno_tricubic_interpolate_grid() reuses the weights of
+ * each axis for a rectilinear target grid.
+ *
+ * The field is stored with \f$x\f$ fastest: \f$f(i,j,k)\f$ = f[(k*ny+j)*nx+i].
+ *
+ * # Reference
+ *
+ * - Bermejo, R. and A. Staniforth, 1992: The conversion of semi-Lagrangian
+ *   advection schemes to quasi-monotone schemes. MWR, 120, 2622--2632.
+ */
+#include <stdbool.h>
+#include "tricubic.h"
+
+int eno_tricubic_axis_lagrange /// compute cubic Lagrange weights along an axis
+  (
+    int n,      ///< [in]  # of nodes, n >= 4
+    double *x,  ///< [in]  x[n] ascending or descending
+    int m,      ///< [in]  # of targets
+    double *xo, ///< [in]  xo[m] targets
+    int *idx,   ///< [out] idx[m] cell containing the targets, 0 <= idx[l] <= n-2
+    double *w   ///< [out] w[4*m] weights of the stencil
+  )
+{
+  int i = 0;
+
+  for (int l = 0; l < m; l++) {
+    i = MAX(0, MIN(n-2, eno_search_linear(x, n, xo[l], i)));
+    idx[l] = i;
+    eno_cubic_lagrange_weights(&x[MAX(0, MIN(n-4, i-1))], xo[l], &w[4*l]);
+  }
+  return 0;
+}
+
+int eno_tricubic_axis_hermite /// compute cubic Hermite weights along an axis
+  (
+    int n,      ///< [in]  # of nodes, n >= 4
+    double *x,  ///< [in]  x[n] ascending or descending
+    int m,      ///< [in]  # of targets
+    double *xo, ///< [in]  xo[m] targets
+    int *idx,   ///< [out] idx[m] cell containing the targets, 0 <= idx[l] <= n-2
+    double *w   ///< [out] w[4*m] weights of the stencil
+  )
+{
+  int i = 0;
+
+  for (int l = 0; l < m; l++) {
+    i = MAX(0, MIN(n-2, eno_search_linear(x, n, xo[l], i)));
+    double *wl = &w[4*l];
+    idx[l] = i;
+    eno_cubic_hermite_weights(x, n, i, (xo[l] - x[i]) / (x[i+1] - x[i]), wl);
+// shift the stencil inside, the weight outside is zero
+    if (i == 0) {
+      wl[0] = wl[1]; wl[1] = wl[2]; wl[2] = wl[3]; wl[3] = 0.0;
+    } else if (i == n-2) {
+      wl[3] = wl[2]; wl[2] = wl[1]; wl[1] = wl[0]; wl[0] = 0.0;
+    }
+  }
+  return 0;
+}
+
+/// first node of the stencil of cell i
+static int stencil(int n, int i)
+{
+  return MAX(0, MIN(n-4, i-1));
+}
+
+/// sum of 4x4x4 values from f0 weighted by wx, wy and wz, limited to the cell at o if mono
+static double tensor(double *f0, int sy, int sz, double *wx, double *wy, double *wz,
+  bool mono, int ox, int oy, int oz)
+{
+  double s = 0.0;
+
+  for (int c = 0; c < 4; c++) {
+    double sc = 0.0;
+    for (int b = 0; b < 4; b++) {
+      double *fb = &f0[c*sz+b*sy];
+      sc += wy[b] * (wx[0]*fb[0] + wx[1]*fb[1] + wx[2]*fb[2] + wx[3]*fb[3]);
+    }
+    s += wz[c] * sc;
+  }
+  if (mono) {
+    double *fc = &f0[oz*sz+oy*sy+ox];
+    double lo = fc[0], hi = fc[0];
+    for (int c = 0; c < 2; c++) {
+      for (int b = 0; b < 2; b++) {
+        for (int a = 0; a < 2; a++) {
+          double v = fc[c*sz+b*sy+a];
+          lo = MIN(lo, v);
+          hi = MAX(hi, v);
+        }
+      }
+    }
+    s = MAX(lo, MIN(hi, s));
+  }
+  return s;
+}
+
+int eno_tricubic_interpolate /// interpolate f at n points with per-axis weights of each point
+  (
+    int nx,     ///< [in]  # of nodes in x
+    int ny,     ///< [in]  # of nodes in y
+    int nz,     ///< [in]  # of nodes in z
+    double *f,  ///< [in]  f[nz*ny*nx]
+    bool mono,  ///< [in]  limit to the range of the cell
+    int n,      ///< [in]  # of points
+    int *ix,    ///< [in]  ix[n] from eno_tricubic_axis_*() of x
+    double *wx, ///< [in]  wx[4*n]
+    int *iy,    ///< [in]  iy[n] from eno_tricubic_axis_*() of y
+    double *wy, ///< [in]  wy[4*n]
+    int *iz,    ///< [in]  iz[n] from eno_tricubic_axis_*() of z
+    double *wz, ///< [in]  wz[4*n]
+    double *fo  ///< [out] fo[n]
+  )
+{
+#pragma omp parallel for
+  for (int l = 0; l < n; l++) {
+    int sx = stencil(nx, ix[l]), sy = stencil(ny, iy[l]), sz = stencil(nz, iz[l]);
+    double *f0 = &f[(sz*ny+sy)*nx+sx];
+    fo[l] = tensor(f0, nx, nx*ny, &wx[4*l], &wy[4*l], &wz[4*l],
+      mono, ix[l]-sx, iy[l]-sy, iz[l]-sz);
+  }
+  return 0;
+}
+
+int eno_tricubic_interpolate_grid /// interpolate f on an mx x my x mz rectilinear grid
+  (
+    int nx,     ///< [in]  # of nodes in x
+    int ny,     ///< [in]  # of nodes in y
+    int nz,     ///< [in]  # of nodes in z
+    double *f,  ///< [in]  f[nz*ny*nx]
+    bool mono,  ///< [in]  limit to the range of the cell
+    int mx,     ///< [in]  # of targets in x
+    int *ix,    ///< [in]  ix[mx] from eno_tricubic_axis_*() of x
+    double *wx, ///< [in]  wx[4*mx]
+    int my,     ///< [in]  # of targets in y
+    int *iy,    ///< [in]  iy[my] from eno_tricubic_axis_*() of y
+    double *wy, ///< [in]  wy[4*my]
+    int mz,     ///< [in]  # of targets in z
+    int *iz,    ///< [in]  iz[mz] from eno_tricubic_axis_*() of z
+    double *wz, ///< [in]  wz[4*mz]
+    double *fo  ///< [out] fo[mz*my*mx]
+  )
+{
+#pragma omp parallel for collapse(2)
+  for (int k = 0; k < mz; k++) {
+    for (int j = 0; j < my; j++) {
+      int sy = stencil(ny, iy[j]), sz = stencil(nz, iz[k]);
+      double *fj = &f[(sz*ny+sy)*nx];
+      double *foj = &fo[(k*my+j)*mx];
+      for (int i = 0; i < mx; i++) {
+        int sx = stencil(nx, ix[i]);
+        foj[i] = tensor(&fj[sx], nx, nx*ny, &wx[4*i], &wy[4*j], &wz[4*k],
+          mono, ix[i]-sx, iy[j]-sy, iz[k]-sz);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,302 @@
+/// Vertical interpolation from hybrid model levels
+/**
+ * @file vinterp.c
+ * @author Takeshi Enomoto
+ *
+ * # Algorithm
+ *
+ * Many fields on the full levels of many columns are interpolated
+ * to pressure levels in \f$\ln p\f$ or to height levels in \f$z\f$.
+ *
+ * 1. Full-level pressure of a block of columns is calculated level by level
+ *    by eno_sigmap_calc_p_grid() and its logarithm by elogv().
+ * 2. Each target level is located in all columns of the block in lockstep
+ *    by the masked bisection eno_search_column().
+ * 3. Cubic Lagrange weights by eno_cubic_lagrange_weights() are computed once
+ *    per target and column and applied to all fields.
+ *    The stencil is shifted inside near the top and the lowest levels.
+ * 4. Above the top full level the top value is used.
+ *    Between the lowest full level and the surface,
+ *    temperature (VINTERP_T) is interpolated linearly to the surface temperature
+ *    by eno_extrapolate_Ts_grid(), geopotential height (VINTERP_Z) to the surface height
+ *    and other fields (VINTERP_OTHER) are kept constant.
+ *    Below the surface temperature and geopotential height on pressure levels
+ *    are marked while interpolating and extrapolated afterwards over all columns
+ *    by eno_extrapolate_T_grid() and eno_extrapolate_z_grid(),
+ *    and temperature on height levels with the standard lapse rate.
+ *
+ * Fields are stored level by level with columns fastest:
+ * field v at full level k+1 (top to bottom) of column c is f[(v*n+k)*ncol+c],
+ * and the output at target l is fo[(v*nt+l)*ncol+c].
+ * Columns are processed in blocks of COLUMN_BLOCK in parallel,
+ * each thread with its own work arrays.
+ *
+ * The engine holds the sigmap structure of the model levels,
+ * which is available to the caller as vi->sigmap.
+ */
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include "vinterp.h"
+
+/// interpolate nf fields of a block of columns to nt targets
+static void interpolate_block
+  (
+    int n,           ///< [in]  # of full levels
+    int ncol,        ///< [in]  # of all columns
+    int c0,          ///< [in]  first column of the block
+    int nb,          ///< [in]  # of columns in the block
+    bool height,     ///< [in]  targets are heights
+    double *xc,      ///< [in]  xc[n*nb] vertical coordinate ln p or z of the block
+    double *xs,      ///< [in]  xs[nb] surface coordinate ln ps or zs
+    double *ps,      ///< [in]  ps[nb] surface pressure
+    double *zs,      ///< [in]  zs[nb] surface height
+    double *Ts,      ///< [in]  Ts[nb] surface temperature
+    int nf,          ///< [in]  # of fields
+    int *kind,       ///< [in]  kind[nf]
+    double *f,       ///< [in]  f[nf*n*ncol]
+    int nt,          ///< [in]  # of targets
+    double *xt,      ///< [in]  xt[nt] targets, ln p or z
+    double *pt,      ///< [in]  pt[nt] target pressure, NULL for heights
+    double *xv,      ///< [out] xv[nb] work
+    int *idx,        ///< [out] idx[nb] work
+    double *sig,     ///< [out] sig[nt*ncol] p/ps of the targets below the surface, skipped for heights
+    bool *mask,      ///< [out] mask[nt*ncol] true below the surface, skipped for heights
+    double *fo       ///< [out] fo[nf*nt*ncol], T and z below the surface left for the caller on pressure levels
+  )
+{
+  const double dTdz = eno_isa_dTdz(0);
+
+  for (int l = 0; l < nt; l++) {
+#pragma omp simd
+    for (int c = 0; c < nb; c++) {
+      xv[c] = xt[l];
+    }
+    eno_search_column(xc, n, nb, xv, idx);
+    for (int c = 0; c < nb; c++) {
+      int k = idx[c];
+      int cc = c0 + c;
+      bool below = false;
+      if (k < 0) {
+        for (int v = 0; v < nf; v++) {
+          fo[(v*nt+l)*ncol+cc] = f[(v*n)*ncol+cc];
+        }
+      } else if (k < n-1) {
+        int s = MAX(0, MIN(n-4, k-1));
+        double xa[4], w[4];
+        for (int m = 0; m < 4; m++) {
+          xa[m] = xc[(s+m)*nb+c];
+        }
+        eno_cubic_lagrange_weights(xa, xt[l], w);
+        for (int v = 0; v < nf; v++) {
+          double *fv = &f[(v*n+s)*ncol+cc];
+          fo[(v*nt+l)*ncol+cc] = w[0]*fv[0] + w[1]*fv[ncol] + w[2]*fv[2*ncol] + w[3]*fv[3*ncol];
+        }
+      } else {
+        double xn = xc[(n-1)*nb+c];
+        bool above = height ? (xt[l] >= xs[c]) : (xt[l] <= xs[c]);
+        double t = (xt[l] - xn) / (xs[c] - xn);
+        below = !above && !height;
+        for (int v = 0; v < nf; v++) {
+          double fn = f[(v*n+n-1)*ncol+cc];
+          double y;
+          if (below && (kind[v] == VINTERP_T || kind[v] == VINTERP_Z)) {
+            continue;
+          }
+          switch (kind[v]) {
+          case VINTERP_T:
+            y = above ? fn + t*(Ts[c] - fn) : Ts[c] + dTdz*(xt[l] - zs[c]);
+            break;
+          case VINTERP_Z:
+            y = height ? xt[l] : fn + t*(zs[c] - fn);
+            break;
+          case VINTERP_OTHER:
+          default:
+            y = fn;
+          }
+          fo[(v*nt+l)*ncol+cc] = y;
+        }
+      }
+      if (!height) {
+        mask[l*ncol+cc] = below;
+        sig[l*ncol+cc] = pt[l] / ps[c];
+      }
+    }
+  }
+}
+
+/// first field of kind T or -1
+static int find_T(int nf, int *kind)
+{
+  for (int v = 0; v < nf; v++) {
+    if (kind[v] == VINTERP_T) {
+      return v;
+    }
+  }
+  return -1;
+}
+
+/// full-level ln p and surface temperature of a block of columns
+static void prepare_block
+  (
+    eno_sigmap_t *sigmap, ///< [in]  sigmap structure
+    int ncol,             ///< [in]  # of all columns
+    int c0,               ///< [in]  first column of the block
+    int nb,               ///< [in]  # of columns in the block
+    double *ps,           ///< [in]  ps[ncol] surface pressure
+    double *zs,           ///< [in]  zs[ncol] surface height
+    int iT,               ///< [in]  temperature field or -1 for the standard atmosphere
+    double *f,            ///< [in]  f[nf*n*ncol]
+    double *ph,           ///< [out] ph[(n+1)*nb] work
+    double *pf,           ///< [out] pf[(n+1)*nb] work
+    double *lnp,          ///< [out] lnp[n*nb] full-level ln p, skipped if NULL
+    double *Ts            ///< [out] Ts[nb] surface temperature
+  )
+{
+  int n = sigmap->n;
+  double T0 = eno_air_T0 + eno_isa_T(0);
+  double dTdz = eno_isa_dTdz(0);
+  double sigl[COLUMN_BLOCK];
+
+  if (lnp != NULL || iT >= 0) {
+    eno_sigmap_calc_p_grid(sigmap, nb, &ps[c0], SIGMAP_LEVEL_MAJOR, ph, NULL, pf);
+  }
+  if (lnp != NULL) {
+    elogv(n*nb, &pf[nb], lnp, ELOG_FULL);
+  }
+  if (iT >= 0) {
+#pragma omp simd
+    for (int c = 0; c < nb; c++) {
+      sigl[c] = pf[n*nb+c] / ps[c0+c];
+    }
+    eno_extrapolate_Ts_grid(nb, &f[(iT*n+n-1)*ncol+c0], sigl, Ts);
+  } else {
+#pragma omp simd
+    for (int c = 0; c < nb; c++) {
+      Ts[c] = T0 + dTdz*zs[c0+c];
+    }
+  }
+}
+
+eno_vinterp_t *eno_vinterp_init /// allocate vertical interpolation engine
+  (
+    int n,      ///< [in] # of layers
+    double *a,  ///< [in] a[n+1] hybrid A: p
+    double *b,  ///< [in] b[n+1] hybrid B: sigma
+    double ptop ///< [in] model top pressure (Pa)
+  )
+{
+  eno_vinterp_t *vi;
+  vi = (eno_vinterp_t *)malloc(sizeof(eno_vinterp_t));
+
+  vi->n = n;
+  vi->sigmap = eno_sigmap_init(n, a, b, ptop);
+  return vi;
+}
+
+int eno_vinterp_clean /// deallocate vertical interpolation engine
+  (
+    eno_vinterp_t *vi ///< [inout] vertical interpolation engine
+  )
+{
+  eno_sigmap_clean(vi->sigmap);
+  free(vi);
+  return 0;
+}
+
+int eno_vinterp_p /// interpolate fields on model levels to pressure levels
+  (
+    eno_vinterp_t *vi,    ///< [in]  vertical interpolation engine
+    int ncol,             ///< [in]  # of columns
+    double *ps,           ///< [in]  ps[ncol] surface pressure, Pa
+    double *zs,           ///< [in]  zs[ncol] surface geopotential height, m
+    int nf,               ///< [in]  # of fields
+    int *kind,            ///< [in]  kind[nf] VINTERP_T, VINTERP_Z or VINTERP_OTHER
+    double *f,            ///< [in]  f[nf*n*ncol] fields on full levels
+    int np,               ///< [in]  # of pressure levels
+    double *plev,         ///< [in]  plev[np] pressure levels, Pa
+    double *fo            ///< [out] fo[nf*np*ncol]
+  )
+{
+  int n = vi->n;
+  int iT = find_T(nf, kind);
+  double *lnpt = (double *)malloc(sizeof(double) * np);
+  double *Ts = (double *)malloc(sizeof(double) * ncol);
+  double *sig = (double *)malloc(sizeof(double) * np * ncol);
+  bool *mask = (bool *)malloc(sizeof(bool) * np * ncol);
+
+  elogv(np, plev, lnpt, ELOG_FULL);
+#pragma omp parallel
+  {
+    double *ph = (double *)malloc(sizeof(double) * 2 * (n+1) * COLUMN_BLOCK);
+    double *lnp = (double *)malloc(sizeof(double) * n * COLUMN_BLOCK);
+    double lnps[COLUMN_BLOCK], xv[COLUMN_BLOCK];
+    int idx[COLUMN_BLOCK];
+#pragma omp for
+    for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+      int nb = MIN(COLUMN_BLOCK, ncol - c0);
+      prepare_block(vi->sigmap, ncol, c0, nb, ps, zs, iT, f, ph, &ph[(n+1)*nb], lnp, &Ts[c0]);
+      elogv(nb, &ps[c0], lnps, ELOG_FULL);
+      interpolate_block(n, ncol, c0, nb, false, lnp, lnps, &ps[c0], &zs[c0], &Ts[c0],
+        nf, kind, f, np, lnpt, plev, xv, idx, sig, mask, fo);
+    }
+    free(ph);
+    free(lnp);
+  }
+// below the surface
+  for (int v = 0; v < nf; v++) {
+    if (kind[v] == VINTERP_T) {
+      eno_extrapolate_T_grid(np, ncol, zs, Ts, sig, mask, &fo[v*np*ncol]);
+    } else if (kind[v] == VINTERP_Z) {
+      eno_extrapolate_z_grid(np, ncol, zs, Ts, sig, mask, &fo[v*np*ncol]);
+    }
+  }
+  free(lnpt);
+  free(Ts);
+  free(sig);
+  free(mask);
+  return 0;
+}
+
+int eno_vinterp_z /// interpolate fields on model levels to height levels
+  (
+    eno_vinterp_t *vi,    ///< [in]  vertical interpolation engine
+    int ncol,             ///< [in]  # of columns
+    double *ps,           ///< [in]  ps[ncol] surface pressure, Pa
+    double *zs,           ///< [in]  zs[ncol] surface geopotential height, m
+    double *z,            ///< [in]  z[n*ncol] full-level geopotential height, m
+    int nf,               ///< [in]  # of fields
+    int *kind,            ///< [in]  kind[nf] VINTERP_T, VINTERP_Z or VINTERP_OTHER
+    double *f,            ///< [in]  f[nf*n*ncol] fields on full levels
+    int nz,               ///< [in]  # of height levels
+    double *zlev,         ///< [in]  zlev[nz] height levels, m
+    double *fo            ///< [out] fo[nf*nz*ncol]
+  )
+{
+  int n = vi->n;
+  int iT = find_T(nf, kind);
+
+#pragma omp parallel
+  {
+    double *ph = (double *)malloc(sizeof(double) * 2 * (n+1) * COLUMN_BLOCK);
+    double *zc = (double *)malloc(sizeof(double) * n * COLUMN_BLOCK);
+    double Ts[COLUMN_BLOCK], xv[COLUMN_BLOCK];
+    int idx[COLUMN_BLOCK];
+#pragma omp for
+    for (int c0 = 0; c0 < ncol; c0 += COLUMN_BLOCK) {
+      int nb = MIN(COLUMN_BLOCK, ncol - c0);
+      prepare_block(vi->sigmap, ncol, c0, nb, ps, zs, iT, f, ph, &ph[(n+1)*nb], NULL, Ts);
+      for (int k = 0; k < n; k++) {
+#pragma omp simd
+        for (int c = 0; c < nb; c++) {
+          zc[k*nb+c] = z[k*ncol+c0+c];
+        }
+      }
+      interpolate_block(n, ncol, c0, nb, true, zc, &zs[c0], &ps[c0], &zs[c0], Ts,
+        nf, kind, f, nz, zlev, NULL, xv, idx, NULL, NULL, fo);
+    }
+    free(ph);
+    free(zc);
+  }
+  return 0;
+}
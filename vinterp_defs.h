@@ -0,0 +1,3 @@
+#define VINTERP_OTHER 0
+#define VINTERP_T     1
+#define VINTERP_Z     2
@@ -0,0 +1,4 @@
+typedef struct eno_vinterp_t {
+  int n;
+  eno_sigmap_t *sigmap;
+}
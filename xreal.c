@@ -1,4 +1,7 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <stdbool.h>
 /// Extended exponent of floating-point numbers
@@ -242,3 +245,282 @@ void eno_xreal_base10(xreal_t x, xreal_t *y)
     y->i = y->i + i10 * x.i;
   }
 }
+
+/// multiply decimal pairs (m1, d1)*(m2, d2) keeping 1 <= m < 10
+static void mul10(double m1, int d1, double m2, int d2, double *m, int *d)
+{
+  *m = m1 * m2;
+  *d = d1 + d2;
+  if (*m >= 10.0) {
+    *m /= 10.0;
+    ++*d;
+  }
+}
+
+/// calculate (2^IND/10^I10)^i as a decimal pair by binary powering
+static void pow10pair(int i, double *m, int *d)
+{
+  double mz;
+  int dz;
+
+  // 2^IND/10^I10 = 9.74...e-1, 10^I10/2^IND = 1.02...e0
+  if (i < 0) {
+    mz = ldexp(1.0e289, -IND);
+    dz = 0;
+    i = -i;
+  } else {
+    mz = ldexp(1.0e-288, IND);
+    dz = -1;
+  }
+  *m = 1.0;
+  *d = 0;
+  while (i) {
+    if (i & 1) {
+      mul10(*m, *d, mz, dz, m, d);
+    }
+    i >>= 1;
+    mul10(mz, dz, mz, dz, &mz, &dz);
+  }
+}
+
+/// scale f by 10^k, rounded once for |k| <= 22 and twice above, where p10[k] is inexact
+static double scale10(eno_xreal_table_t *tab, double f, int k)
+{
+  return k >= 0 ? f * tab->p10[k] : f / tab->p10[-k];
+}
+
+eno_xreal_table_t *eno_xreal_table_init /// allocate power tables for decimal conversion
+  (
+    int imax ///< [in] largest |x.i| served from the table
+  )
+{
+  eno_xreal_table_t *tab;
+
+  tab = (eno_xreal_table_t *)malloc(sizeof(eno_xreal_table_t));
+  tab->imax = imax;
+  tab->pm = (double *)malloc(sizeof(double) * (2*imax+1));
+  tab->pe = (int *)malloc(sizeof(int) * (2*imax+1));
+  tab->p10 = (double *)malloc(sizeof(double) * (K10+1));
+  for (int i = -imax; i < imax+1; i++) {
+    pow10pair(i, &tab->pm[i+imax], &tab->pe[i+imax]);
+  }
+  for (int k = 0; k < K10+1; k++) {
+    tab->p10[k] = pow(10.0, k);
+  }
+  return tab;
+}
+
+void eno_xreal_table_clean(eno_xreal_table_t *tab)
+{
+  free(tab->pm);
+  free(tab->pe);
+  free(tab->p10);
+  free(tab);
+}
+
+void eno_xreal_base10_array /// convert x to decimal mantissa y.p and exponent y.i
+  (
+    eno_xreal_table_t *tab, ///< [in] tables by eno_xreal_table_init()
+    int n,                  ///< [in] number of values
+    xreal_t *x,             ///< [in] X-numbers
+    xreal_t *y              /**< [out] \f$x = y.p\times 10^{y.i}\f$
+                             *         with \f$1 \le |y.p| < 10\f$, or 0
+                             */
+  )
+{
+  const double log10_2 = 0.30102999566398120;
+  int imax = tab->imax;
+
+  for (int j = 0; j < n; j++) {
+    xreal_t z = x[j];
+    double m, t;
+    int d, b, k;
+
+    eno_xreal_norm(&z);
+    if (z.p == 0.0) {
+      y[j].p = 0.0;
+      y[j].i = 0;
+      continue;
+    }
+    if (z.i >= -imax && z.i <= imax) {
+      m = tab->pm[z.i+imax];
+      d = tab->pe[z.i+imax];
+    } else {
+      pow10pair(z.i, &m, &d);
+    }
+    // x = p * 2^(IND i) = (p * m) * 10^(d + I10 i)
+    t = z.p * m;
+    frexp(t, &b);
+    k = (int)floor((b - 1) * log10_2);
+    m = scale10(tab, t, -k);
+    if (fabs(m) >= 10.0) {
+      ++k;
+      m = scale10(tab, t, -k);
+    }
+    y[j].p = m;
+    y[j].i = k + d + I10 * z.i;
+  }
+}
+
+void eno_xreal_from_base10_array /// convert decimal mantissa y.p and exponent y.i to x
+  (
+    eno_xreal_table_t *tab, ///< [in] tables by eno_xreal_table_init()
+    int n,                  ///< [in] number of values
+    xreal_t *y,             ///< [in] \f$y.p\times 10^{y.i}\f$
+    xreal_t *x              /**< [out] normalized X-numbers, may be y.
+                             *   A round trip through eno_xreal_base10_array()
+                             *   reproduces x.i and x.p within about 6 ulp (2e-15),
+                             *   since the tables and 10^k with |k| > 22 are rounded
+                             */
+  )
+{
+  const double log2_10 = 3.32192809488736235;
+  int imax = tab->imax;
+
+  for (int j = 0; j < n; j++) {
+    double m;
+    int d, q;
+
+    if (y[j].p == 0.0) {
+      x[j].p = 0.0;
+      x[j].i = 0;
+      continue;
+    }
+    // choose q so that y / 2^(IND q) stays within the range of double
+    q = (int)floor(y[j].i * log2_10 / IND + 0.5);
+    if (q >= -imax && q <= imax) {
+      m = tab->pm[imax-q];
+      d = tab->pe[imax-q];
+    } else {
+      pow10pair(-q, &m, &d);
+    }
+    // 2^(-IND q) = m * 10^(d - I10 q)
+    x[j].p = scale10(tab, y[j].p * m, y[j].i + d - I10 * q);
+    x[j].i = q;
+    eno_xreal_norm(&x[j]);
+  }
+}
+
+int eno_xreal_write_text /// write x as lines of decimal mantissa and exponent
+  (
+    eno_xreal_table_t *tab, ///< [in] tables by eno_xreal_table_init()
+    FILE *fp,               ///< [in] output stream
+    int n,                  ///< [in] number of values
+    xreal_t *x              ///< [in] X-numbers
+  )
+{
+  xreal_t y[IOBUF];
+
+  for (int j = 0; j < n; j += IOBUF) {
+    int nc = MIN(IOBUF, n - j);
+    eno_xreal_base10_array(tab, nc, &x[j], y);
+    for (int k = 0; k < nc; k++) {
+      if (fprintf(fp, "%.16f %d\n", y[k].p, y[k].i) < 0) {
+        return j + k;
+      }
+    }
+  }
+  return n;
+}
+
+int eno_xreal_read_text /// read lines written by eno_xreal_write_text()
+  (
+    eno_xreal_table_t *tab, ///< [in] tables by eno_xreal_table_init()
+    FILE *fp,               ///< [in] input stream
+    int n,                  ///< [in] number of values
+    xreal_t *x              ///< [out] X-numbers, within 2e-15 of those written
+  )
+{
+  int j;
+
+  for (j = 0; j < n; j++) {
+    if (fscanf(fp, "%lf %d", &x[j].p, &x[j].i) != 2) {
+      break;
+    }
+  }
+  eno_xreal_from_base10_array(tab, j, x, x);
+  return j;
+}
+
+/// pack y into a record of XREC bytes: little-endian IEEE double p and int32 i
+static void pack_record(xreal_t y, unsigned char *b)
+{
+  uint64_t u;
+  uint32_t v = (uint32_t)(int32_t)y.i;
+
+  memcpy(&u, &y.p, sizeof(u));
+  for (int k = 0; k < 8; k++) {
+    b[k] = (unsigned char)(u >> (8*k));
+  }
+  for (int k = 0; k < 4; k++) {
+    b[8+k] = (unsigned char)(v >> (8*k));
+  }
+}
+
+/// unpack a record written by pack_record()
+static void unpack_record(unsigned char *b, xreal_t *y)
+{
+  uint64_t u = 0;
+  uint32_t v = 0;
+
+  for (int k = 0; k < 8; k++) {
+    u |= (uint64_t)b[k] << (8*k);
+  }
+  for (int k = 0; k < 4; k++) {
+    v |= (uint32_t)b[8+k] << (8*k);
+  }
+  memcpy(&y->p, &u, sizeof(u));
+  y->i = (int32_t)v;
+}
+
+int eno_xreal_write_binary /// write x as records of decimal mantissa and exponent
+  (
+    eno_xreal_table_t *tab, ///< [in] tables by eno_xreal_table_init()
+    FILE *fp,               ///< [in] output stream
+    int n,                  ///< [in] number of values
+    xreal_t *x              /**< [in] X-numbers, written as records of XREC bytes:
+                             *        little-endian IEEE double mantissa
+                             *        followed by little-endian int32 exponent
+                             */
+  )
+{
+  xreal_t y[IOBUF];
+  unsigned char b[IOBUF*XREC];
+
+  for (int j = 0; j < n; j += IOBUF) {
+    int nc = MIN(IOBUF, n - j);
+    eno_xreal_base10_array(tab, nc, &x[j], y);
+    for (int k = 0; k < nc; k++) {
+      pack_record(y[k], &b[k*XREC]);
+    }
+    int nw = fwrite(b, XREC, nc, fp);
+    if (nw < nc) {
+      return j + nw;
+    }
+  }
+  return n;
+}
+
+int eno_xreal_read_binary /// read records written by eno_xreal_write_binary()
+  (
+    eno_xreal_table_t *tab, ///< [in] tables by eno_xreal_table_init()
+    FILE *fp,               ///< [in] input stream
+    int n,                  ///< [in] number of values
+    xreal_t *x              ///< [out] X-numbers, within 2e-15 of those written
+  )
+{
+  unsigned char b[IOBUF*XREC];
+
+  for (int j = 0; j < n; j += IOBUF) {
+    int nc = MIN(IOBUF, n - j);
+    int nr = fread(b, XREC, nc, fp);
+    for (int k = 0; k < nr; k++) {
+      unpack_record(&b[k*XREC], &x[j+k]);
+    }
+    eno_xreal_from_base10_array(tab, nr, &x[j], &x[j]);
+    if (nr < nc) {
+      return j + nr;
+    }
+  }
+  return n;
+}
@@ -4,3 +4,7 @@
 #define BIGI  ipow(2.0,-IND)
 #define BIGS  ipow(2.0, INDH)
 #define BIGSI ipow(2.0,-INDH)
+#define I10   289
+#define K10   308
+#define IOBUF 256
+#define XREC  12
@@ -2,3 +2,10 @@ typedef struct xreal_t {
   double p;
   int i;
 }
+
+typedef struct eno_xreal_table_t {
+  int imax;
+  double *pm;
+  int *pe;
+  double *p10;
+}